@@ -0,0 +1,78 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+struct BenchmarkOptions {
+    bool quick;             // Smaller sweeps for CI and smoke runs
+    int repeats;            // Timed runs per case; the best is reported
+    double soakSeconds;     // Simulated time for the soak case
+    bool cold;              // Drop file pages from the OS cache before asset loads
+    std::string assetDir;   // Project1 folder holding assets/ and map.txt
+    std::string scratchDir; // Where temporary maps and packs are written
+};
+
+enum class BenchmarkStatus {
+    Ok,
+    Failed, // A check inside the case did not hold
+    Skipped // Not runnable here (no GL context, missing asset)
+};
+
+// One measured configuration of a case
+struct BenchmarkResult {
+    std::string name;
+    std::map<std::string, double> params;
+    std::uint64_t operations; // Work items per run: items, ticks, tiles, sprites...
+    double seconds;           // Best wall time of one run
+    std::map<std::string, double> metrics;
+    BenchmarkStatus status;
+    std::string message;
+
+    BenchmarkResult(const std::string& name)
+        : name(name), operations(0), seconds(0.0), status(BenchmarkStatus::Ok) {
+    }
+    void fail(const std::string& why) {
+        status = BenchmarkStatus::Failed;
+        message = why;
+    }
+    void skip(const std::string& why) {
+        status = BenchmarkStatus::Skipped;
+        message = why;
+    }
+};
+
+// A named case; it may report several results (e.g. one per entity count)
+struct BenchmarkCase {
+    std::string name;
+    std::function<void(const BenchmarkOptions&, std::vector<BenchmarkResult>&)> run;
+};
+
+// Case lists, one per source file
+void registerSimBenchmarks(std::vector<BenchmarkCase>& cases);
+#ifdef BENCHMARK_WITH_SFML
+void registerRenderBenchmarks(std::vector<BenchmarkCase>& cases);
+#endif
+
+// Keeps a computed value alive so the optimizer cannot drop the work
+void benchmarkKeep(double value);
+
+// Best wall time in seconds of repeats calls to body
+template <typename Body>
+double bestOf(int repeats, Body body) {
+    double best = 0.0;
+    for (int run = 0; run < repeats; ++run) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        body();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (run == 0 || elapsed.count() < best)
+            best = elapsed.count();
+    }
+    return best;
+}
+
+#endif // BENCHMARK_H
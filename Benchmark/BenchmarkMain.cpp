@@ -0,0 +1,199 @@
+#include "Benchmark.h"
+#include "SimdKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifndef BENCHMARK_ASSET_DIR
+#define BENCHMARK_ASSET_DIR "../Project1"
+#endif
+
+namespace {
+
+volatile double keepSink;
+
+const char* statusName(BenchmarkStatus status) {
+    switch (status) {
+    case BenchmarkStatus::Ok: return "ok";
+    case BenchmarkStatus::Failed: return "failed";
+    default: return "skipped";
+    }
+}
+
+std::string jsonString(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20) {
+            char escape[8];
+            std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+            quoted += escape;
+        }
+        else {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+// JSON has no NaN or infinity
+std::string jsonNumber(double value) {
+    if (!std::isfinite(value))
+        return "null";
+    std::ostringstream out;
+    out.precision(10);
+    out << value;
+    return out.str();
+}
+
+void writeNumberMap(std::ostream& out, const std::map<std::string, double>& values) {
+    out << '{';
+    bool first = true;
+    for (const auto& entry : values) {
+        out << (first ? "" : ", ") << jsonString(entry.first) << ": " << jsonNumber(entry.second);
+        first = false;
+    }
+    out << '}';
+}
+
+void writeJson(std::ostream& out, const BenchmarkOptions& options, const std::vector<BenchmarkResult>& results) {
+    out << "{\n";
+    out << "  \"suite\": \"fruit-picker\",\n";
+    out << "  \"timestamp\": " << static_cast<long long>(std::time(nullptr)) << ",\n";
+    out << "  \"simd\": " << jsonString(simdLevelName(activeSimdLevel())) << ",\n";
+    out << "  \"quick\": " << (options.quick ? "true" : "false") << ",\n";
+    out << "  \"repeats\": " << options.repeats << ",\n";
+    out << "  \"results\": [";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& result = results[i];
+        double nsPerOp = result.operations ? result.seconds * 1e9 / result.operations : 0.0;
+        double opsPerSecond = result.seconds > 0.0 ? result.operations / result.seconds : 0.0;
+        out << (i ? ",\n" : "\n");
+        out << "    {\"name\": " << jsonString(result.name) << ", \"status\": " << jsonString(statusName(result.status));
+        out << ", \"params\": ";
+        writeNumberMap(out, result.params);
+        out << ", \"operations\": " << result.operations << ", \"seconds\": " << jsonNumber(result.seconds)
+            << ", \"ns_per_op\": " << jsonNumber(nsPerOp) << ", \"ops_per_sec\": " << jsonNumber(opsPerSecond);
+        out << ", \"metrics\": ";
+        writeNumberMap(out, result.metrics);
+        if (!result.message.empty())
+            out << ", \"message\": " << jsonString(result.message);
+        out << '}';
+    }
+    out << "\n  ]\n}\n";
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --quick              smaller sweeps\n"
+              << "  --filter <text>      only cases whose name contains text\n"
+              << "  --repeats <n>        timed runs per case, best reported (default 3)\n"
+              << "  --soak-seconds <s>   simulated seconds for the soak case (default 86400)\n"
+              << "  --cold               evict asset files from the OS cache before each load\n"
+              << "  --assets <dir>       Project1 folder (default " << BENCHMARK_ASSET_DIR << ")\n"
+              << "  --scratch <dir>      folder for temporary files (default .)\n"
+              << "  --out <file>         write JSON there instead of stdout\n"
+              << "  --list               print case names and exit\n";
+}
+
+} // namespace
+
+void benchmarkKeep(double value) {
+    keepSink = keepSink + value;
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    options.quick = false;
+    options.repeats = 3;
+    options.soakSeconds = 86400.0;
+    options.cold = false;
+    options.assetDir = BENCHMARK_ASSET_DIR;
+    options.scratchDir = ".";
+    std::string filter;
+    std::string outFile;
+    bool listOnly = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--quick")
+            options.quick = true;
+        else if (arg == "--cold")
+            options.cold = true;
+        else if (arg == "--list")
+            listOnly = true;
+        else if (arg == "--filter" && hasValue)
+            filter = argv[++i];
+        else if (arg == "--repeats" && hasValue)
+            options.repeats = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--soak-seconds" && hasValue)
+            options.soakSeconds = std::atof(argv[++i]);
+        else if (arg == "--assets" && hasValue)
+            options.assetDir = argv[++i];
+        else if (arg == "--scratch" && hasValue)
+            options.scratchDir = argv[++i];
+        else if (arg == "--out" && hasValue)
+            outFile = argv[++i];
+        else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<BenchmarkCase> cases;
+    registerSimBenchmarks(cases);
+#ifdef BENCHMARK_WITH_SFML
+    registerRenderBenchmarks(cases);
+#endif
+
+    std::vector<BenchmarkResult> results;
+    for (const BenchmarkCase& benchmarkCase : cases) {
+        if (!filter.empty() && benchmarkCase.name.find(filter) == std::string::npos)
+            continue;
+        if (listOnly) {
+            std::cout << benchmarkCase.name << std::endl;
+            continue;
+        }
+        // Progress goes to stderr so stdout stays valid JSON
+        std::cerr << "running " << benchmarkCase.name << std::endl;
+        std::size_t first = results.size();
+        benchmarkCase.run(options, results);
+        for (std::size_t i = first; i < results.size(); ++i) {
+            std::cerr << "  " << results[i].name << ": " << statusName(results[i].status);
+            if (results[i].operations)
+                std::cerr << ", " << results[i].seconds * 1e9 / results[i].operations << " ns/op";
+            if (!results[i].message.empty())
+                std::cerr << " (" << results[i].message << ")";
+            std::cerr << std::endl;
+        }
+    }
+    if (listOnly)
+        return 0;
+
+    if (outFile.empty()) {
+        writeJson(std::cout, options, results);
+    }
+    else {
+        std::ofstream out(outFile);
+        if (!out.is_open()) {
+            std::cerr << "Failed to write results: " << outFile << std::endl;
+            return 1;
+        }
+        writeJson(out, options, results);
+    }
+
+    for (const BenchmarkResult& result : results) {
+        if (result.status == BenchmarkStatus::Failed)
+            return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,513 @@
+#include "Benchmark.h"
+#include "AssetPack.h"
+#include "Autotile.h"
+#include "GameSim.h"
+#include "Global.hpp"
+#include "Hud.h"
+#include "ResourceCache.h"
+#include "SpriteBatch.h"
+#include "TileMap.h"
+#include "Tileset.h"
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <string>
+#ifdef __unix__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Counts every heap allocation in the process so steady-frame checks measure
+// what actually happens, including allocations inside SFML
+static std::atomic<std::uint64_t> heapAllocations(0);
+
+void* operator new(std::size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+namespace {
+
+const char* NO_CONTEXT = "no OpenGL context; run under xvfb-run with LIBGL_ALWAYS_SOFTWARE=1";
+
+// Offscreen target; false when no GL context can be created
+bool createTarget(sf::RenderTexture& target, unsigned int width, unsigned int height) {
+    return target.create(width, height);
+}
+
+// Drop a file's pages from the OS cache so the next read comes from disk
+void evictFromCache(const std::string& file) {
+#ifdef __unix__
+    int fd = ::open(file.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        ::fdatasync(fd);
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+    }
+#else
+    (void)file;
+#endif
+}
+
+std::vector<std::size_t> spriteCounts(const BenchmarkOptions& options) {
+    if (options.quick)
+        return { 1000, 10000, 100000 };
+    return { 1000, 10000, 100000, 1000000 };
+}
+
+void benchmarkBatch(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+    sf::RenderTexture target;
+    bool hasContext = createTarget(target, WINDOW_WIDTH, WINDOW_HEIGHT);
+
+    // One texture is the atlas; four is the tree/player/apple/bomb layout from before it
+    std::vector<sf::Texture> textures(4);
+    if (hasContext) {
+        for (sf::Texture& texture : textures)
+            texture.create(64, 64);
+    }
+
+    SpriteBatch batch;
+    for (std::size_t count : spriteCounts(options)) {
+        for (std::size_t textureCount : { 1u, 4u }) {
+            BenchmarkResult generate("batch/generate");
+            generate.params["sprites"] = static_cast<double>(count);
+            generate.params["textures"] = static_cast<double>(textureCount);
+            SimRandom random(41);
+            std::vector<float> x(count), y(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                x[i] = static_cast<float>(random.range(WINDOW_WIDTH));
+                y[i] = static_cast<float>(random.range(WINDOW_HEIGHT));
+            }
+
+            // Vertex generation only; flushing is timed separately
+            generate.seconds = bestOf(options.repeats, [&] {
+                batch.begin();
+                for (std::size_t i = 0; i < count; ++i)
+                    batch.draw(textures[i % textureCount], sf::IntRect(0, 0, 60, 60), x[i], y[i]);
+            });
+            generate.operations = count;
+
+            if (!hasContext) {
+                generate.message = std::string("draw calls not checked: ") + NO_CONTEXT;
+                results.push_back(generate);
+                continue;
+            }
+
+            BenchmarkResult flush("batch/flush");
+            flush.params = generate.params;
+            flush.seconds = bestOf(options.repeats, [&] {
+                batch.begin();
+                for (std::size_t i = 0; i < count; ++i)
+                    batch.draw(textures[i % textureCount], sf::IntRect(0, 0, 60, 60), x[i], y[i]);
+                target.clear();
+                batch.flush(target);
+                target.display();
+            });
+            flush.operations = count;
+            flush.metrics["draw_calls"] = static_cast<double>(batch.drawCalls());
+            flush.metrics["vertices"] = static_cast<double>(batch.vertexCount());
+            if (batch.drawCalls() != textureCount)
+                flush.fail("expected one draw call per texture");
+            else if (batch.spriteCount() != count)
+                flush.fail("batched sprite count does not match");
+            results.push_back(generate);
+            results.push_back(flush);
+        }
+    }
+}
+
+void benchmarkTileMap(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+    const int tileSize = 16;
+    std::string tileset = options.assetDir + "/assets/Tilesets/Grass.png";
+    sf::RenderTexture target;
+    if (!createTarget(target, 1024, 1024)) {
+        BenchmarkResult result("tilemap/build");
+        result.skip(NO_CONTEXT);
+        results.push_back(result);
+        return;
+    }
+
+    ResourceCache resources;
+    TileGenerator generator = [](int x, int y, int layer) {
+        return static_cast<std::uint16_t>((x * 7 + y * 13 + layer) % 77);
+    };
+
+    for (int side : { 10, 100, 1000 }) {
+        std::size_t tiles = static_cast<std::size_t>(side) * side;
+        sf::View wholeMap(sf::FloatRect(0.0f, 0.0f, static_cast<float>(side * tileSize), static_cast<float>(side * tileSize)));
+        target.setView(wholeMap);
+
+        // First render builds every chunk's geometry
+        BenchmarkResult build("tilemap/build");
+        build.params["tiles"] = static_cast<double>(tiles);
+        std::size_t drawCalls = 0;
+        std::uint64_t chunkBuilds = 0;
+        build.seconds = bestOf(options.repeats, [&] {
+            TileMap map(resources, tileset, tileSize, side, side, 1, generator);
+            target.clear();
+            map.render(target);
+            target.display();
+            drawCalls = map.getLastDrawCalls();
+            chunkBuilds = map.getChunkBuildCount();
+        });
+        build.operations = tiles;
+        build.metrics["draw_calls"] = static_cast<double>(drawCalls);
+        build.metrics["chunk_builds"] = static_cast<double>(chunkBuilds);
+        results.push_back(build);
+
+        // Later frames only draw the resident chunks
+        BenchmarkResult steady("tilemap/render");
+        steady.params["tiles"] = static_cast<double>(tiles);
+        TileMap map(resources, tileset, tileSize, side, side, 1, generator);
+        if (!map.isLoaded()) {
+            // The tileset ships with the game, like the HUD font
+            steady.fail("Grass.png failed to load");
+            results.push_back(steady);
+            return;
+        }
+        map.render(target);
+        std::uint64_t buildsBefore = map.getChunkBuildCount();
+        const int frames = 20;
+        steady.seconds = bestOf(options.repeats, [&] {
+            for (int frame = 0; frame < frames; ++frame) {
+                target.clear();
+                map.render(target);
+                target.display();
+            }
+        });
+        steady.operations = static_cast<std::uint64_t>(tiles) * frames;
+        steady.metrics["draw_calls"] = static_cast<double>(map.getLastDrawCalls());
+        steady.metrics["ms_per_frame"] = steady.seconds * 1000.0 / frames;
+        if (map.getChunkBuildCount() != buildsBefore)
+            steady.fail("static frames rebuilt chunk geometry");
+        results.push_back(steady);
+
+        // The old path: one sf::Sprite draw per tile, capped since it is the slow one
+        if (tiles > (options.quick ? 10000u : 100000u))
+            continue;
+        BenchmarkResult perSprite("tilemap/per_sprite");
+        perSprite.params["tiles"] = static_cast<double>(tiles);
+        TextureHandle texture = resources.getTexture(tileset);
+        int columns = std::max(1, static_cast<int>(texture->getSize().x) / tileSize);
+        sf::Sprite sprite(*texture);
+        perSprite.seconds = bestOf(options.repeats, [&] {
+            target.clear();
+            for (int y = 0; y < side; ++y) {
+                for (int x = 0; x < side; ++x) {
+                    int tile = generator(x, y, 0);
+                    sprite.setTextureRect(sf::IntRect((tile % columns) * tileSize, (tile / columns) * tileSize, tileSize, tileSize));
+                    sprite.setPosition(static_cast<float>(x * tileSize), static_cast<float>(y * tileSize));
+                    target.draw(sprite);
+                }
+            }
+            target.display();
+        });
+        perSprite.operations = tiles;
+        perSprite.metrics["draw_calls"] = static_cast<double>(tiles);
+        results.push_back(perSprite);
+    }
+}
+
+void benchmarkTileMapPan(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+    BenchmarkResult result("tilemap/pan");
+    const int side = 100000;
+    const int tileSize = 16;
+    const int frames = options.quick ? 300 : 3000;
+    result.params["map_tiles_per_side"] = side;
+    result.params["frames"] = frames;
+
+    sf::RenderTexture target;
+    if (!createTarget(target, WINDOW_WIDTH, WINDOW_HEIGHT)) {
+        result.skip(NO_CONTEXT);
+        results.push_back(result);
+        return;
+    }
+
+    // 10^10 tiles: only possible because generated maps store no tiles
+    ResourceCache resources;
+    TileMap map(resources, options.assetDir + "/assets/Tilesets/Grass.png", tileSize, side, side, 1,
+                [](int x, int y, int) { return static_cast<std::uint16_t>((x ^ y) % 77); });
+    if (!map.isLoaded()) {
+        result.fail("Grass.png failed to load");
+        results.push_back(result);
+        return;
+    }
+
+    const float chunkPixels = static_cast<float>(TileMap::CHUNK_SIZE * tileSize);
+    const std::size_t maxVisible = static_cast<std::size_t>((WINDOW_WIDTH / chunkPixels + 2) * (WINDOW_HEIGHT / chunkPixels + 2));
+    std::size_t maxDrawCalls = 0, maxResident = 0;
+    sf::View view(sf::FloatRect(0.0f, 0.0f, static_cast<float>(WINDOW_WIDTH), static_cast<float>(WINDOW_HEIGHT)));
+    result.seconds = bestOf(1, [&] {
+        for (int frame = 0; frame < frames; ++frame) {
+            // Diagonal pan, fast enough to cross a chunk every few frames
+            view.move(97.0f, 41.0f);
+            target.setView(view);
+            target.clear();
+            map.render(target);
+            target.display();
+            maxDrawCalls = std::max(maxDrawCalls, map.getLastDrawCalls());
+            maxResident = std::max(maxResident, map.getResidentChunkCount());
+        }
+    });
+    result.operations = frames;
+    result.metrics["max_draw_calls"] = static_cast<double>(maxDrawCalls);
+    result.metrics["max_resident_chunks"] = static_cast<double>(maxResident);
+    result.metrics["chunk_builds_per_frame"] = static_cast<double>(map.getChunkBuildCount()) / frames;
+    if (maxDrawCalls > maxVisible)
+        result.fail("drew more chunks than can be visible");
+    else if (maxResident > TileMap::DEFAULT_MAX_RESIDENT_CHUNKS)
+        result.fail("resident chunks exceeded the cap");
+    results.push_back(result);
+}
+
+void benchmarkAutotile(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+    Tileset tileset;
+    if (!tileset.loadFromFile(options.assetDir + "/assets/Tilesets/Grass.tileset")) {
+        BenchmarkResult result("autotile/resolve");
+        result.skip("Grass.tileset not found");
+        results.push_back(result);
+        return;
+    }
+
+    const int side = options.quick ? 512 : 2048;
+    SimRandom random(43);
+    std::vector<std::uint8_t> cells(static_cast<std::size_t>(side) * side);
+    for (std::uint8_t& cell : cells)
+        cell = random.range(3) != 0;
+
+    for (unsigned int threads : { 1u, 0u }) {
+        BenchmarkResult result("autotile/resolve");
+        result.params["cells"] = static_cast<double>(cells.size());
+        result.params["threads"] = threads; // 0 = one band per hardware thread
+        AutotileLayer layer(tileset, side, side);
+        result.seconds = bestOf(options.repeats, [&] { layer.setTerrain(cells, threads); });
+        result.operations = cells.size();
+        results.push_back(result);
+    }
+
+    // Single-cell edits must match a full resolve of the edited grid
+    BenchmarkResult edit("autotile/edit");
+    const int edits = options.quick ? 100000 : 1000000;
+    AutotileLayer incremental(tileset, side, side);
+    incremental.setTerrain(cells);
+    std::uint64_t changed = 0;
+    edit.seconds = bestOf(1, [&] {
+        for (int i = 0; i < edits; ++i) {
+            int x = random.range(side), y = random.range(side);
+            bool filled = random.range(2) != 0;
+            changed += incremental.setCell(x, y, filled);
+            cells[static_cast<std::size_t>(y) * side + x] = filled;
+        }
+    });
+    edit.operations = edits;
+    edit.metrics["tiles_changed_per_edit"] = static_cast<double>(changed) / edits;
+    AutotileLayer full(tileset, side, side);
+    full.setTerrain(cells);
+    if (full.getTiles() != incremental.getTiles())
+        edit.fail("incremental edits diverged from a full resolve");
+    results.push_back(edit);
+}
+
+void benchmarkAssetLoads(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+    std::vector<PackSource> sources;
+    for (const char* name : { "assets/tree.png", "assets/background_level1.jpg", "assets/player_spritesheet.png",
+                              "assets/apple.png", "assets/bomb.png" })
+        sources.push_back({ name, options.assetDir + "/" + name });
+
+    std::string encodedPack = options.scratchDir + "/bench_encoded.pak";
+    std::string rawPack = options.scratchDir + "/bench_raw.pak";
+    if (!buildPack(sources, encodedPack, false) || !buildPack(sources, rawPack, true)) {
+        BenchmarkResult result("assets/load");
+        result.fail("could not build the benchmark packs");
+        results.push_back(result);
+        return;
+    }
+
+    // Pixel bytes of every image, to check all three paths decode the same thing
+    std::uint64_t expectedBytes = 0;
+    for (const PackSource& source : sources) {
+        sf::Image image;
+        if (image.loadFromFile(source.file))
+            expectedBytes += static_cast<std::uint64_t>(image.getSize().x) * image.getSize().y * 4;
+    }
+
+    struct Variant {
+        const char* name;
+        std::string pack; // Empty for loose files
+    };
+    for (const Variant& variant : { Variant{ "loose", "" }, Variant{ "pack_encoded", encodedPack }, Variant{ "pack_raw", rawPack } }) {
+        BenchmarkResult result(std::string("assets/load/") + variant.name);
+        result.params["cold"] = options.cold ? 1 : 0;
+        result.params["files"] = static_cast<double>(sources.size());
+        std::uint64_t bytes = 0;
+        double total = 0.0;
+        for (int run = 0; run < options.repeats; ++run) {
+            if (options.cold) {
+                for (const PackSource& source : sources)
+                    evictFromCache(source.file);
+                if (!variant.pack.empty())
+                    evictFromCache(variant.pack);
+            }
+            double seconds = bestOf(1, [&] {
+                bytes = 0;
+                AssetPack pack;
+                bool usePack = !variant.pack.empty() && pack.open(variant.pack);
+                for (const PackSource& source : sources) {
+                    sf::Image image;
+                    if (usePack ? pack.loadImage(source.name, image) : image.loadFromFile(source.file))
+                        bytes += static_cast<std::uint64_t>(image.getSize().x) * image.getSize().y * 4;
+                }
+            });
+            // Cold runs are averaged (each one is a fresh disk read); warm runs keep the best
+            total = options.cold ? total + seconds / options.repeats : (run == 0 ? seconds : std::min(total, seconds));
+        }
+        result.seconds = total;
+        result.operations = sources.size();
+        result.metrics["pixel_bytes"] = static_cast<double>(bytes);
+        if (bytes != expectedBytes)
+            result.fail("decoded pixels differ from the loose files");
+        results.push_back(result);
+    }
+    std::remove(encodedPack.c_str());
+    std::remove(rawPack.c_str());
+}
+
+void benchmarkAssetPackEmptyEntry(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+    BenchmarkResult result("assets/pack_empty_entry");
+    std::string emptyFile = options.scratchDir + "/bench_empty.txt";
+    std::string textFile = options.scratchDir + "/bench_text.txt";
+    std::string packFile = options.scratchDir + "/bench_empty.pak";
+    std::ofstream(emptyFile, std::ios::binary | std::ios::trunc).close();
+    std::ofstream(textFile, std::ios::binary | std::ios::trunc) << "after";
+
+    // The empty entry sorts first, so the text entry checks nothing shifted after it
+    std::vector<PackSource> sources = { { "a_empty.txt", emptyFile }, { "b_text.txt", textFile } };
+    if (!buildPack(sources, packFile, false)) {
+        result.fail("a zero-byte file failed the pack build");
+    }
+    else {
+        // Scoped so the mapping is gone before the file is removed
+        AssetPack pack;
+        std::string empty = "not empty";
+        std::string text;
+        if (!pack.open(packFile))
+            result.fail("the pack with an empty entry did not open");
+        else if (!pack.readText("a_empty.txt", empty) || !empty.empty())
+            result.fail("the empty entry did not read back as empty");
+        else if (!pack.readText("b_text.txt", text) || text != "after")
+            result.fail("the entry after the empty one read back wrong");
+    }
+    results.push_back(result);
+
+    std::remove(packFile.c_str());
+    std::remove(emptyFile.c_str());
+    std::remove(textFile.c_str());
+}
+
+void benchmarkHud(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+    BenchmarkResult result("hud/steady_frame");
+    ResourceCache resources;
+    Hud hud;
+    // The font ships with the game, so failing to load it is a failure, not a skip
+    if (!hud.load(resources, options.assetDir + "/ARIAL.TTF", 24)) {
+        result.fail("ARIAL.TTF failed to load");
+        results.push_back(result);
+        return;
+    }
+
+    sf::RenderTexture target;
+    if (!createTarget(target, WINDOW_WIDTH, WINDOW_HEIGHT)) {
+        result.skip(NO_CONTEXT);
+        results.push_back(result);
+        return;
+    }
+
+    // A score line of the same length drawn straight through SFML ("Score: 99"),
+    // for whatever SFML and the driver allocate per draw call
+    std::vector<sf::Vertex> reference(9 * 6);
+    sf::RenderStates referenceStates;
+    referenceStates.texture = &hud.getFont().getTexture(24);
+
+    // First frames create the driver's buffers and are not steady
+    for (int frame = 0; frame < 10; ++frame) {
+        hud.draw(target);
+        target.draw(reference.data(), reference.size(), sf::Triangles, referenceStates);
+    }
+
+    // Mostly unchanged scores, as in play: only changes may rebuild
+    const int frames = options.quick ? 10000 : 100000;
+    Hud::Stats before = hud.getStats();
+    std::uint64_t readsBefore = resources.getFileReads();
+    std::uint64_t hudAllocations = 0;
+    int changes = 0;
+    result.seconds = bestOf(1, [&] {
+        std::uint64_t allocationsBefore = heapAllocations.load();
+        for (int frame = 0; frame < frames; ++frame) {
+            int score = frame / 100;
+            if (frame % 100 == 0)
+                ++changes;
+            hud.setScore(score);
+            hud.draw(target);
+        }
+        hudAllocations = heapAllocations.load() - allocationsBefore;
+    });
+    result.operations = frames;
+    std::uint64_t fileReads = resources.getFileReads() - readsBefore;
+    Hud::Stats after = hud.getStats();
+
+    std::uint64_t allocationsBefore = heapAllocations.load();
+    for (int frame = 0; frame < frames; ++frame)
+        target.draw(reference.data(), reference.size(), sf::Triangles, referenceStates);
+    std::uint64_t driverAllocations = heapAllocations.load() - allocationsBefore;
+
+    result.metrics["geometry_rebuilds"] = static_cast<double>(after.geometryRebuilds - before.geometryRebuilds);
+    result.metrics["allocations"] = static_cast<double>(hudAllocations);
+    result.metrics["driver_allocations"] = static_cast<double>(driverAllocations);
+    result.metrics["file_reads"] = static_cast<double>(fileReads);
+    if (fileReads != 0)
+        result.fail("steady frames read files");
+    else if (hudAllocations > driverAllocations)
+        result.fail("steady frames allocated beyond the draw call itself");
+    else if (after.geometryRebuilds - before.geometryRebuilds > static_cast<std::uint64_t>(changes))
+        result.fail("rebuilt geometry without a score change");
+    results.push_back(result);
+}
+
+} // namespace
+
+void registerRenderBenchmarks(std::vector<BenchmarkCase>& cases) {
+    cases.push_back({ "batch", benchmarkBatch });
+    cases.push_back({ "tilemap/build", benchmarkTileMap });
+    cases.push_back({ "tilemap/pan", benchmarkTileMapPan });
+    cases.push_back({ "autotile", benchmarkAutotile });
+    cases.push_back({ "assets/load", benchmarkAssetLoads });
+    cases.push_back({ "assets/pack_empty_entry", benchmarkAssetPackEmptyEntry });
+    cases.push_back({ "hud/steady_frame", benchmarkHud });
+}
@@ -0,0 +1,614 @@
+#include "Benchmark.h"
+#include "CollisionGrid.h"
+#include "EntityLifecycle.h"
+#include "GameSim.h"
+#include "Global.hpp"
+#include "ItemPool.h"
+#include "MapFile.h"
+#include "NetSnapshot.h"
+#include "Profiler.h"
+#include "SimdKernels.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace {
+
+// Entity counts swept by the scaling cases
+std::vector<std::size_t> entityCounts(const BenchmarkOptions& options) {
+    if (options.quick)
+        return { 1000, 10000, 100000 };
+    return { 1000, 10000, 100000, 1000000 };
+}
+
+// Enough repetitions of a per-item pass to keep each run around ten million item updates
+int passesFor(std::size_t count, const BenchmarkOptions& options) {
+    std::size_t target = options.quick ? 1000000 : 10000000;
+    return static_cast<int>(std::max<std::size_t>(1, target / count));
+}
+
+// Items scattered over the screen, alternating kinds (the item spawn blocks of the old main())
+void fillPool(ItemPool& pool, std::size_t count, std::uint32_t seed) {
+    SimRandom random(seed);
+    for (std::size_t i = 0; i < count; ++i) {
+        ItemKind kind = i % 4 == 3 ? ItemKind::Bomb : ItemKind::Apple;
+        pool.spawn(kind, static_cast<float>(random.range(WINDOW_WIDTH - 60)), static_cast<float>(random.range(WINDOW_HEIGHT)));
+    }
+}
+
+// Player-sized query boxes spread along the bottom of the screen
+void playerBoxes(int players, std::vector<float>& boxes) {
+    boxes.clear();
+    for (int p = 0; p < players; ++p) {
+        float left = (WINDOW_WIDTH - PLAYER_WIDTH) * (p + 0.5f) / players;
+        float top = WINDOW_HEIGHT - PLAYER_HEIGHT;
+        boxes.insert(boxes.end(), { left, top, left + PLAYER_WIDTH, top + PLAYER_HEIGHT });
+    }
+}
+
+// Reference narrow phase: every item against one box, same rule as the kernels
+void bruteForceQuery(const ItemPool& pool, const ItemKindInfo* kinds, const float* box, std::vector<std::uint32_t>& hits) {
+    for (std::size_t i = 0; i < pool.size(); ++i) {
+        const ItemKindInfo& info = kinds[static_cast<int>(pool.kind[i])];
+        float left = pool.posX[i] + info.collisionInset;
+        float top = pool.posY[i] + info.collisionInset;
+        float right = pool.posX[i] + info.width - info.collisionInset;
+        float bottom = pool.posY[i] + info.height - info.collisionInset;
+        if (left < box[2] && box[0] < right && top < box[3] && box[1] < bottom)
+            hits.push_back(static_cast<std::uint32_t>(i));
+    }
+}
+
+void benchmarkPoolSpawn(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+    for (std::size_t count : entityCounts(options)) {
+        BenchmarkResult result("item_pool/spawn");
+        result.params["items"] = static_cast<double>(count);
+        std::size_t capacity = 0;
+        // Starts from the game's initial capacity so growth is part of the cost
+        result.seconds = bestOf(options.repeats, [&] {
+            ItemPool pool(1024);
+            fillPool(pool, count, 7);
+            capacity = pool.capacity();
+            benchmarkKeep(pool.posX[count - 1]);
+        });
+        result.operations = count;
+        result.metrics["capacity"] = static_cast<double>(capacity);
+        results.push_back(result);
+    }
+}
+
+void benchmarkPoolChurn(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+    for (std::size_t count : entityCounts(options)) {
+        BenchmarkResult result("item_pool/churn");
+        result.params["items"] = static_cast<double>(count);
+        ItemPool pool(count);
+        fillPool(pool, count, 11);
+        std::size_t capacity = pool.capacity();
+        SimRandom random(13);
+
+        // Steady state: every operation retires one item and spawns a replacement
+        std::size_t churn = std::max<std::size_t>(count, 1000000);
+        result.seconds = bestOf(options.repeats, [&] {
+            for (std::size_t i = 0; i < churn; ++i) {
+                pool.remove(static_cast<std::size_t>(random.range(static_cast<int>(pool.size()))));
+                pool.spawn(ItemKind::Apple, static_cast<float>(random.range(WINDOW_WIDTH)), 0.0f);
+            }
+        });
+        result.operations = churn;
+        result.metrics["id_high_water"] = static_cast<double>(pool.lifecycle().highWater());
+        result.metrics["recycled_ids"] = static_cast<double>(pool.lifecycle().recycledCount());
+        if (pool.capacity() != capacity)
+            result.fail("pool grew under steady-state churn");
+        else if (pool.lifecycle().highWater() > count + 1)
+            result.fail("entity ids are not being recycled");
+        results.push_back(result);
+    }
+}
+
+void benchmarkItemUpdate(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+    for (std::size_t count : entityCounts(options)) {
+        BenchmarkResult result("item/update");
+        result.params["items"] = static_cast<double>(count);
+        ItemPool pool(count);
+        fillPool(pool, count, 17);
+        int passes = passesFor(count, options);
+        const float step = ITEM_SPEED * SIM_TICK;
+
+        // The per-tick item pass of GameSim: integrate, then retire what left
+        // the screen; retired items respawn at the top to keep the count fixed
+        result.seconds = bestOf(options.repeats, [&] {
+            for (int pass = 0; pass < passes; ++pass) {
+                integratePositions(pool.posY.data(), pool.prevPosY.data(), pool.size(), step);
+                for (std::size_t i = 0; i < pool.size();) {
+                    if (pool.posY[i] > WINDOW_HEIGHT) {
+                        float x = pool.posX[i];
+                        pool.remove(i);
+                        pool.spawn(ItemKind::Apple, x, 0.0f);
+                    }
+                    else {
+                        ++i;
+                    }
+                }
+            }
+        });
+        result.operations = static_cast<std::uint64_t>(count) * passes;
+        result.params["passes"] = passes;
+        results.push_back(result);
+    }
+}
+
+void benchmarkCollision(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+    const GameSimConfig config = GameSim::defaultConfig();
+    std::vector<float> boxes;
+    std::vector<std::uint32_t> hits, expected;
+
+    for (std::size_t count : entityCounts(options)) {
+        ItemPool pool(count);
+        fillPool(pool, count, 23);
+        CollisionGrid grid(static_cast<float>(WINDOW_WIDTH), static_cast<float>(WINDOW_HEIGHT), COLLISION_CELL_SIZE);
+
+        // Enough player counts to find where the grid starts to beat scanning (COLLISION_SCAN_*)
+        for (int players : { 1, 2, 3, 4, 8 }) {
+            playerBoxes(players, boxes);
+
+            // One tick: rebuild the grid, then one query per player
+            BenchmarkResult result("collision/grid");
+            result.params["items"] = static_cast<double>(count);
+            result.params["players"] = players;
+            int ticks = std::max(3, passesFor(count, options) / 10);
+            std::size_t hitCount = 0;
+            result.seconds = bestOf(options.repeats, [&] {
+                for (int tick = 0; tick < ticks; ++tick) {
+                    grid.rebuild(pool, config.itemKinds);
+                    hits.clear();
+                    for (int p = 0; p < players; ++p)
+                        grid.query(boxes[p * 4], boxes[p * 4 + 1], boxes[p * 4 + 2], boxes[p * 4 + 3], hits);
+                    hitCount = hits.size();
+                }
+            });
+            result.operations = ticks;
+            result.params["ticks"] = ticks;
+            result.metrics["hits"] = static_cast<double>(hitCount);
+            result.metrics["ns_per_item_tick"] = result.seconds * 1e9 / (static_cast<double>(ticks) * count);
+
+            // Cross-check every query against brute force
+            std::size_t mismatches = 0;
+            for (int p = 0; p < players; ++p) {
+                hits.clear();
+                expected.clear();
+                grid.query(boxes[p * 4], boxes[p * 4 + 1], boxes[p * 4 + 2], boxes[p * 4 + 3], hits);
+                bruteForceQuery(pool, config.itemKinds, &boxes[p * 4], expected);
+                std::sort(hits.begin(), hits.end());
+                if (hits != expected)
+                    ++mismatches;
+            }
+            result.metrics["mismatched_queries"] = static_cast<double>(mismatches);
+            if (mismatches)
+                result.fail("grid query disagrees with brute force");
+            results.push_back(result);
+
+            // The per-player loop over every item that the grid replaced
+            if (count > (options.quick ? 10000u : 100000u))
+                continue;
+            BenchmarkResult brute("collision/brute_force");
+            brute.params["items"] = static_cast<double>(count);
+            brute.params["players"] = players;
+            brute.seconds = bestOf(options.repeats, [&] {
+                for (int tick = 0; tick < ticks; ++tick) {
+                    expected.clear();
+                    for (int p = 0; p < players; ++p)
+                        bruteForceQuery(pool, config.itemKinds, &boxes[p * 4], expected);
+                }
+            });
+            brute.operations = ticks;
+            brute.params["ticks"] = ticks;
+            brute.metrics["ns_per_item_tick"] = brute.seconds * 1e9 / (static_cast<double>(ticks) * count);
+            results.push_back(brute);
+        }
+    }
+}
+
+void benchmarkSimdKernels(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+    const std::size_t count = options.quick ? 100000 : 1000000;
+    const int passes = options.quick ? 10 : 50;
+    SimRandom random(29);
+    std::vector<float> left(count), top(count), right(count), bottom(count), start(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        left[i] = static_cast<float>(random.range(WINDOW_WIDTH));
+        top[i] = static_cast<float>(random.range(WINDOW_HEIGHT));
+        right[i] = left[i] + 40.0f + random.range(30);
+        bottom[i] = top[i] + 40.0f + random.range(30);
+        start[i] = static_cast<float>(random.range(1000)) + random.range(1000) / 1000.0f;
+    }
+    const float queryLeft = 800.0f, queryTop = 700.0f, queryRight = 950.0f, queryBottom = 1050.0f;
+
+    // Scalar results are the reference for every other level
+    SimdLevel detected = detectSimdLevel();
+    std::vector<std::uint8_t> referenceMask((count + 7) / 8), mask((count + 7) / 8);
+    std::vector<float> referencePos(start), referencePrev(count);
+    setSimdLevel(SimdLevel::Scalar);
+    std::size_t referenceHits = testBoxes(left.data(), top.data(), right.data(), bottom.data(), count,
+                                          queryLeft, queryTop, queryRight, queryBottom, referenceMask.data());
+    integratePositions(referencePos.data(), referencePrev.data(), count, 1.6666666f);
+
+    for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2 }) {
+        BenchmarkResult boxes(std::string("simd/test_boxes/") + simdLevelName(level));
+        BenchmarkResult integrate(std::string("simd/integrate/") + simdLevelName(level));
+        boxes.params["boxes"] = static_cast<double>(count);
+        integrate.params["items"] = static_cast<double>(count);
+        if (static_cast<int>(level) > static_cast<int>(detected)) {
+            boxes.skip("not supported by this CPU");
+            integrate.skip("not supported by this CPU");
+            results.push_back(boxes);
+            results.push_back(integrate);
+            continue;
+        }
+        setSimdLevel(level);
+
+        std::size_t hits = 0;
+        boxes.seconds = bestOf(options.repeats, [&] {
+            for (int pass = 0; pass < passes; ++pass)
+                hits = testBoxes(left.data(), top.data(), right.data(), bottom.data(), count,
+                                 queryLeft, queryTop, queryRight, queryBottom, mask.data());
+        });
+        boxes.operations = static_cast<std::uint64_t>(count) * passes;
+        boxes.metrics["hits"] = static_cast<double>(hits);
+        if (hits != referenceHits || mask != referenceMask)
+            boxes.fail("hit mask differs from scalar");
+
+        std::vector<float> pos(start), prev(count);
+        integrate.seconds = bestOf(options.repeats, [&] {
+            for (int pass = 0; pass < passes; ++pass)
+                integratePositions(pos.data(), prev.data(), count, 0.0f);
+        });
+        integrate.operations = static_cast<std::uint64_t>(count) * passes;
+        // A zero step leaves positions untouched, so one real step can be compared bit for bit
+        integratePositions(pos.data(), prev.data(), count, 1.6666666f);
+        if (pos != referencePos || prev != std::vector<float>(start))
+            integrate.fail("positions differ from scalar");
+
+        results.push_back(boxes);
+        results.push_back(integrate);
+    }
+
+    // Counts that leave a tail after every vector width, each checked bit for
+    // bit against scalar; a guard element past the end catches overruns
+    const std::size_t oddCounts[] = { 1, 7, 9, 31, 100003 };
+    const std::size_t oddMax = 100003;
+    std::vector<float> oddLeft(oddMax), oddTop(oddMax), oddRight(oddMax), oddBottom(oddMax), oddStart(oddMax);
+    for (std::size_t i = 0; i < oddMax; ++i) {
+        oddLeft[i] = static_cast<float>(random.range(WINDOW_WIDTH));
+        oddTop[i] = static_cast<float>(random.range(WINDOW_HEIGHT));
+        oddRight[i] = oddLeft[i] + 40.0f + random.range(30);
+        oddBottom[i] = oddTop[i] + 40.0f + random.range(30);
+        oddStart[i] = static_cast<float>(random.range(1000)) + random.range(1000) / 1000.0f;
+    }
+    const std::uint8_t MASK_GUARD = 0xa5;
+    const float POSITION_GUARD = -12345.0f;
+
+    for (SimdLevel level : { SimdLevel::Sse2, SimdLevel::Avx2 }) {
+        BenchmarkResult check(std::string("simd/odd_counts/") + simdLevelName(level));
+        check.params["counts"] = static_cast<double>(sizeof(oddCounts) / sizeof(oddCounts[0]));
+        if (static_cast<int>(level) > static_cast<int>(detected)) {
+            check.skip("not supported by this CPU");
+            results.push_back(check);
+            continue;
+        }
+
+        int boxMismatches = 0, integrateMismatches = 0;
+        for (std::size_t n : oddCounts) {
+            std::vector<std::uint8_t> expectedMask((n + 7) / 8 + 1, MASK_GUARD), actualMask(expectedMask);
+            std::vector<float> expectedPos(oddStart.begin(), oddStart.begin() + n);
+            expectedPos.push_back(POSITION_GUARD);
+            std::vector<float> actualPos(expectedPos);
+            std::vector<float> expectedPrev(n + 1, POSITION_GUARD), actualPrev(expectedPrev);
+
+            setSimdLevel(SimdLevel::Scalar);
+            std::size_t expectedHits = testBoxes(oddLeft.data(), oddTop.data(), oddRight.data(), oddBottom.data(), n,
+                                                 queryLeft, queryTop, queryRight, queryBottom, expectedMask.data());
+            integratePositions(expectedPos.data(), expectedPrev.data(), n, 1.6666666f);
+
+            setSimdLevel(level);
+            std::size_t actualHits = testBoxes(oddLeft.data(), oddTop.data(), oddRight.data(), oddBottom.data(), n,
+                                               queryLeft, queryTop, queryRight, queryBottom, actualMask.data());
+            integratePositions(actualPos.data(), actualPrev.data(), n, 1.6666666f);
+
+            if (actualHits != expectedHits || actualMask != expectedMask || actualMask.back() != MASK_GUARD)
+                ++boxMismatches;
+            if (std::memcmp(actualPos.data(), expectedPos.data(), actualPos.size() * sizeof(float)) != 0
+                || std::memcmp(actualPrev.data(), expectedPrev.data(), actualPrev.size() * sizeof(float)) != 0
+                || actualPos.back() != POSITION_GUARD || actualPrev.back() != POSITION_GUARD)
+                ++integrateMismatches;
+        }
+        check.metrics["test_boxes_mismatches"] = boxMismatches;
+        check.metrics["integrate_mismatches"] = integrateMismatches;
+        if (boxMismatches)
+            check.fail("hit mask differs from scalar at an odd count");
+        else if (integrateMismatches)
+            check.fail("positions differ from scalar at an odd count");
+        results.push_back(check);
+    }
+    setSimdLevel(detected);
+}
+
+void benchmarkLifecycle(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+    BenchmarkResult result("entity_lifecycle/churn");
+    const std::size_t live = 10000;
+    const std::size_t operations = options.quick ? 1000000 : 10000000;
+    result.params["live"] = static_cast<double>(live);
+    EntityLifecycle lifecycle(live);
+    std::vector<EntityHandle> handles;
+    for (std::size_t i = 0; i < live; ++i)
+        handles.push_back(lifecycle.acquire(static_cast<std::uint32_t>(i)));
+
+    SimRandom random(31);
+    std::size_t staleHandlesAlive = 0;
+    result.seconds = bestOf(options.repeats, [&] {
+        for (std::size_t i = 0; i < operations; ++i) {
+            std::size_t slot = static_cast<std::size_t>(random.range(static_cast<int>(live)));
+            EntityHandle old = handles[slot];
+            lifecycle.release(old.id);
+            handles[slot] = lifecycle.acquire(static_cast<std::uint32_t>(slot));
+            // A recycled id must not revive the old handle
+            if (lifecycle.isAlive(old))
+                ++staleHandlesAlive;
+        }
+    });
+    result.operations = operations;
+    result.metrics["id_high_water"] = static_cast<double>(lifecycle.highWater());
+    if (staleHandlesAlive)
+        result.fail("stale handles reported alive after recycling");
+    results.push_back(result);
+}
+
+void benchmarkGameSimStep(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+    BenchmarkResult result("game_sim/step");
+    const long ticks = options.quick ? 100000 : 1000000;
+    result.params["ticks"] = static_cast<double>(ticks);
+    std::size_t peakItems = 0;
+    result.seconds = bestOf(options.repeats, [&] {
+        GameSim sim(GameSim::defaultConfig());
+        InputState input;
+        for (long tick = 0; tick < ticks; ++tick) {
+            // Sweep across the screen, turning every two seconds
+            input.left = (tick / (2 * SIM_TICK_RATE)) % 2 == 0;
+            input.right = !input.left;
+            sim.step(SIM_TICK, input);
+            peakItems = std::max(peakItems, sim.items().size());
+            if (sim.isGameOver())
+                sim.reset();
+        }
+    });
+    result.operations = static_cast<std::uint64_t>(ticks);
+    result.metrics["peak_items"] = static_cast<double>(peakItems);
+    result.metrics["realtime_factor"] = ticks * SIM_TICK / result.seconds;
+    results.push_back(result);
+}
+
+void benchmarkSoak(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+    // Simulated time, not wall time: a simulated day runs in seconds
+    BenchmarkResult result("game_sim/soak");
+    double simulatedSeconds = options.quick ? std::min(options.soakSeconds, 3600.0) : options.soakSeconds;
+    std::uint64_t ticks = static_cast<std::uint64_t>(simulatedSeconds * SIM_TICK_RATE);
+    result.params["simulated_seconds"] = simulatedSeconds;
+
+    // The run is cut into windows; per-tick work in each is compared with the
+    // first. CPU time rather than wall time, so a preempted window is not slow
+    const int SOAK_WINDOWS = 10;
+    const double SOAK_TIME_TOLERANCE = 0.5;  // Later windows may cost 50% more per tick
+    const double SOAK_ITEM_TOLERANCE = 0.25; // and hold 25% more live items on average
+    const std::uint64_t windowTicks = std::max<std::uint64_t>(1, ticks / SOAK_WINDOWS);
+    std::vector<double> windowSeconds, windowItems;
+
+    GameSim sim(GameSim::defaultConfig());
+    InputState input;
+    std::size_t warmCapacity = 0, peakItems = 0, peakIds = 0;
+    std::uint64_t resets = 0;
+    const std::uint64_t warmupTicks = 60 * SIM_TICK_RATE;
+    result.seconds = bestOf(1, [&] {
+        double windowStart = processCpuSeconds();
+        std::uint64_t itemTicks = 0;
+        for (std::uint64_t tick = 0; tick < ticks; ++tick) {
+            input.left = (tick / (2 * SIM_TICK_RATE)) % 2 == 0;
+            input.right = !input.left;
+            sim.step(SIM_TICK, input);
+            itemTicks += sim.items().size();
+            peakItems = std::max(peakItems, sim.items().size());
+            peakIds = std::max(peakIds, sim.items().lifecycle().highWater());
+            if (tick == warmupTicks)
+                warmCapacity = sim.items().capacity();
+            if (sim.isGameOver()) {
+                sim.reset();
+                ++resets;
+            }
+            if ((tick + 1) % windowTicks == 0) {
+                double now = processCpuSeconds();
+                windowSeconds.push_back(now - windowStart);
+                windowItems.push_back(static_cast<double>(itemTicks) / windowTicks);
+                windowStart = now;
+                itemTicks = 0;
+            }
+        }
+    });
+    result.operations = ticks;
+    result.metrics["resets"] = static_cast<double>(resets);
+    result.metrics["peak_items"] = static_cast<double>(peakItems);
+    result.metrics["peak_entity_ids"] = static_cast<double>(peakIds);
+    result.metrics["pool_capacity"] = static_cast<double>(sim.items().capacity());
+
+    double worstTimeRatio = 0.0, worstItemRatio = 0.0;
+    for (std::size_t window = 1; window < windowSeconds.size(); ++window) {
+        if (windowSeconds[0] > 0.0)
+            worstTimeRatio = std::max(worstTimeRatio, windowSeconds[window] / windowSeconds[0]);
+        if (windowItems[0] > 0.0)
+            worstItemRatio = std::max(worstItemRatio, windowItems[window] / windowItems[0]);
+    }
+    if (!windowSeconds.empty()) {
+        result.metrics["first_window_ns_per_tick"] = windowSeconds[0] * 1e9 / windowTicks;
+        result.metrics["first_window_items"] = windowItems[0];
+    }
+    result.metrics["worst_window_time_ratio"] = worstTimeRatio;
+    result.metrics["worst_window_item_ratio"] = worstItemRatio;
+
+    // Nothing may keep growing once the first minute has settled the pool size
+    if (ticks > warmupTicks && sim.items().capacity() != warmCapacity)
+        result.fail("item pool kept growing after warm-up");
+    else if (peakIds > sim.items().capacity())
+        result.fail("entity ids outgrew the pool");
+    else if (worstTimeRatio > 1.0 + SOAK_TIME_TOLERANCE)
+        result.fail("per-tick time grew over the run");
+    else if (worstItemRatio > 1.0 + SOAK_ITEM_TOLERANCE)
+        result.fail("live item count grew over the run");
+    results.push_back(result);
+}
+
+void benchmarkMapFile(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+    const int side = options.quick ? 512 : 2048;
+    std::string textFile = options.scratchDir + "/bench_map.txt";
+    std::string binaryFile = options.scratchDir + "/bench_map.bin";
+    {
+        std::ofstream text(textFile);
+        SimRandom random(37);
+        for (int y = 0; y < side; ++y) {
+            for (int x = 0; x < side; ++x)
+                text << random.range(64) << (x + 1 < side ? ' ' : '\n');
+        }
+    }
+
+    BenchmarkResult convert("map_file/convert_text");
+    BenchmarkResult load("map_file/load_binary");
+    convert.params["tiles"] = load.params["tiles"] = static_cast<double>(side) * side;
+    bool converted = true;
+    convert.seconds = bestOf(options.repeats, [&] {
+        converted = convertTextMap(textFile, binaryFile, 16) && converted;
+    });
+    convert.operations = static_cast<std::uint64_t>(side) * side;
+
+    // Load is open + validate + one pass over the mapped tiles
+    std::uint64_t checksum = 0;
+    bool opened = true;
+    load.seconds = bestOf(options.repeats, [&] {
+        MapFileReader reader;
+        opened = reader.open(binaryFile) && opened;
+        checksum = 0;
+        for (std::size_t i = 0; opened && i < reader.tileCount(); ++i)
+            checksum += reader.tiles()[i];
+    });
+    load.operations = static_cast<std::uint64_t>(side) * side;
+    load.metrics["checksum"] = static_cast<double>(checksum);
+    if (!converted)
+        convert.fail("conversion failed");
+    if (!opened)
+        load.fail("binary map did not open");
+    results.push_back(convert);
+    results.push_back(load);
+    std::remove(textFile.c_str());
+    std::remove(binaryFile.c_str());
+}
+
+// Hand-written headers that must not open: dimensions past INT_MAX, and a
+// width x height x layers product that wraps to zero in 64 bits
+void benchmarkMapFileHeaders(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+    BenchmarkResult result("map_file/reject_headers");
+    struct Case {
+        std::uint32_t width, height, layers;
+        bool valid;
+    };
+    const Case cases[] = {
+        { 2, 2, 1, true },
+        { 1u << 30, 1u << 30, 16, false },
+        { 0x80000000u, 1, 1, false },
+        { 1, 0x80000000u, 1, false },
+        { 1, 1, 0x80000000u, false },
+        { 3, 2, 1, false }, // One tile more than the file holds
+    };
+    std::string file = options.scratchDir + "/bench_header.bin";
+    int wrong = 0;
+    for (const Case& c : cases) {
+        {
+            MapFileHeader header;
+            std::memcpy(header.magic, MAP_FILE_MAGIC, sizeof(header.magic));
+            header.version = MAP_FILE_VERSION;
+            header.width = c.width;
+            header.height = c.height;
+            header.layers = c.layers;
+            header.tileSize = 16;
+            header.dataOffset = sizeof(MapFileHeader);
+            const std::uint16_t tiles[5] = { 1, 2, 3, 4, 5 };
+            std::ofstream output(file, std::ios::binary | std::ios::trunc);
+            output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            output.write(reinterpret_cast<const char*>(tiles), 4 * sizeof(std::uint16_t));
+        }
+        MapFileReader reader;
+        if (reader.open(file) != c.valid)
+            ++wrong;
+    }
+    std::remove(file.c_str());
+    result.operations = sizeof(cases) / sizeof(cases[0]);
+    result.metrics["wrong_verdicts"] = wrong;
+    if (wrong)
+        result.fail("a bad map header was accepted or a good one rejected");
+    results.push_back(result);
+}
+
+// Snapshots arrive from the network, so a kind the client has no sprite for must not decode
+void benchmarkSnapshotKinds(const BenchmarkOptions&, std::vector<BenchmarkResult>& results) {
+    BenchmarkResult result("net_snapshot/reject_bad_kind");
+    NetSnapshot snapshot;
+    snapshot.tick = 1;
+    snapshot.items.push_back(NetItem{ 3, 0, static_cast<std::uint8_t>(ItemKind::Bomb), 100, 200 });
+    std::vector<std::uint8_t> encoded;
+    NetSnapshot decoded;
+    encodeSnapshot(snapshot, nullptr, encoded);
+    bool goodDecoded = decodeSnapshot(encoded.data(), encoded.size(), nullptr, decoded)
+        && decoded.items.size() == 1 && decoded.items[0].kind == snapshot.items[0].kind;
+
+    int badAccepted = 0;
+    for (int kind = static_cast<int>(ItemKind::Count); kind < 256; ++kind) {
+        snapshot.items[0].kind = static_cast<std::uint8_t>(kind);
+        encodeSnapshot(snapshot, nullptr, encoded);
+        if (decodeSnapshot(encoded.data(), encoded.size(), nullptr, decoded))
+            ++badAccepted;
+    }
+    result.operations = 256 - static_cast<int>(ItemKind::Count) + 1;
+    result.metrics["bad_kinds_accepted"] = badAccepted;
+    if (!goodDecoded)
+        result.fail("a valid snapshot did not decode");
+    else if (badAccepted)
+        result.fail("an unknown item kind decoded");
+    results.push_back(result);
+}
+
+void benchmarkProfilerScope(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+    BenchmarkResult result("profiler/scope");
+    const std::size_t scopes = options.quick ? 1000000 : 10000000;
+    result.params["enabled"] = PROFILER_ENABLED;
+    result.seconds = bestOf(options.repeats, [&] {
+        PROFILE_FRAME_BEGIN();
+        for (std::size_t i = 0; i < scopes; ++i) {
+            PROFILE_SCOPE(ProfilePhase::Items);
+        }
+        PROFILE_FRAME_END();
+    });
+    result.operations = scopes;
+    results.push_back(result);
+}
+
+} // namespace
+
+void registerSimBenchmarks(std::vector<BenchmarkCase>& cases) {
+    cases.push_back({ "item_pool/spawn", benchmarkPoolSpawn });
+    cases.push_back({ "item_pool/churn", benchmarkPoolChurn });
+    cases.push_back({ "item/update", benchmarkItemUpdate });
+    cases.push_back({ "collision", benchmarkCollision });
+    cases.push_back({ "simd", benchmarkSimdKernels });
+    cases.push_back({ "entity_lifecycle/churn", benchmarkLifecycle });
+    cases.push_back({ "game_sim/step", benchmarkGameSimStep });
+    cases.push_back({ "game_sim/soak", benchmarkSoak });
+    cases.push_back({ "map_file", benchmarkMapFile });
+    cases.push_back({ "map_file/reject_headers", benchmarkMapFileHeaders });
+    cases.push_back({ "net_snapshot/reject_bad_kind", benchmarkSnapshotKinds });
+    cases.push_back({ "profiler/scope", benchmarkProfilerScope });
+}
@@ -0,0 +1,198 @@
+#include "AssetLoader.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+AssetLoader::AssetLoader(ResourceCache& resources, unsigned int workerCount)
+    : resources(resources),
+      busyJobs(0),
+      stopping(false) {
+    // Leave a core for the render thread
+    if (workerCount == 0)
+        workerCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    for (unsigned int i = 0; i < workerCount; ++i)
+        workers.emplace_back(&AssetLoader::workerLoop, this);
+}
+
+AssetLoader::~AssetLoader() {
+    // Jobs still queued are dropped; running ones finish first
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    jobAvailable.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+void AssetLoader::workerLoop() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping)
+                return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+        std::lock_guard<std::mutex> lock(mutex);
+        --busyJobs;
+    }
+}
+
+void AssetLoader::recordLocked(const std::string& what) {
+    TimelineEvent event;
+    event.time = clock.getElapsedTime();
+    event.what = what;
+    timeline.push_back(event);
+}
+
+void AssetLoader::mark(const std::string& event) {
+    std::lock_guard<std::mutex> lock(mutex);
+    recordLocked(event);
+}
+
+AssetHandle AssetLoader::loadTexture(const std::string& file) {
+    // A file already requested is never decoded a second time
+    for (AssetHandle existing = 0; existing < assets.size(); ++existing) {
+        if (assets[existing]->file == file)
+            return existing;
+    }
+
+    AssetHandle handle = assets.size();
+    assets.push_back(std::unique_ptr<Asset>(new Asset()));
+    Asset* asset = assets.back().get();
+    asset->file = file;
+    asset->state = AssetState::Queued;
+    asset->pixels = nullptr;
+    asset->uploadedRows = 0;
+    asset->pack = resources.getPack();
+    const PackIndexEntry* packed = asset->pack ? asset->pack->find(file) : nullptr;
+    if (!packed)
+        asset->pack.reset();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    asset->texture = resources.findTexture(file);
+    if (asset->texture) {
+        asset->state = AssetState::Ready;
+        recordLocked("cached " + file);
+        return handle;
+    }
+
+    if (packed && packed->format == PackFormat::RawRgba) {
+        // Nothing to decode: upload() reads the mapped pixels directly
+        asset->pixels = static_cast<const sf::Uint8*>(asset->pack->data(*packed));
+        asset->size = sf::Vector2u(packed->width, packed->height);
+        asset->state = AssetState::Decoded;
+        uploadQueue.push_back(handle);
+        recordLocked("mapped " + file);
+        return handle;
+    }
+
+    recordLocked("queued " + file);
+    ++busyJobs;
+    jobs.push_back([this, asset, handle] {
+        sf::Clock decodeClock;
+        bool decoded = asset->pack ? asset->pack->loadImage(asset->file, asset->image) : asset->image.loadFromFile(asset->file);
+        asset->pixels = asset->image.getPixelsPtr();
+        asset->size = asset->image.getSize();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!decoded) {
+            std::cerr << "Failed to load texture: " << asset->file << std::endl;
+            asset->state = AssetState::Failed;
+            recordLocked("failed " + asset->file);
+            return;
+        }
+        asset->state = AssetState::Decoded;
+        uploadQueue.push_back(handle);
+        recordLocked("decoded " + asset->file + " in " + std::to_string(decodeClock.getElapsedTime().asMilliseconds()) + " ms");
+    });
+    jobAvailable.notify_one();
+    return handle;
+}
+
+std::future<bool> AssetLoader::run(const std::string& name, std::function<bool()> job) {
+    // shared_ptr because std::function needs a copyable callable
+    std::shared_ptr<std::packaged_task<bool()>> task = std::make_shared<std::packaged_task<bool()>>(std::move(job));
+    std::future<bool> result = task->get_future();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    recordLocked("queued " + name);
+    ++busyJobs;
+    jobs.push_back([this, task, name] {
+        (*task)();
+        std::lock_guard<std::mutex> lock(mutex);
+        recordLocked("finished " + name);
+    });
+    jobAvailable.notify_one();
+    return result;
+}
+
+void AssetLoader::update(sf::Time budget) {
+    sf::Clock frameClock;
+    for (;;) {
+        AssetHandle handle;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (uploadQueue.empty())
+                return;
+            handle = uploadQueue.front();
+        }
+
+        // Only this thread touches a Decoded asset, so the upload itself runs unlocked
+        Asset& asset = *assets[handle];
+        sf::Vector2u size = asset.size;
+        if (asset.uploadedRows == 0) {
+            asset.uploading = std::make_shared<sf::Texture>();
+            if (!asset.uploading->create(size.x, size.y))
+                asset.uploading.reset();
+        }
+        if (!asset.uploading) {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::cerr << "Failed to create texture for " << asset.file << std::endl;
+            asset.state = AssetState::Failed;
+            uploadQueue.pop_front();
+            recordLocked("failed " + asset.file);
+            continue;
+        }
+
+        unsigned int rows = std::min(UPLOAD_STRIP_ROWS, size.y - asset.uploadedRows);
+        asset.uploading->update(asset.pixels + static_cast<std::size_t>(asset.uploadedRows) * size.x * 4,
+                             size.x, rows, 0, asset.uploadedRows);
+        asset.uploadedRows += rows;
+
+        if (asset.uploadedRows == size.y) {
+            asset.image = sf::Image();
+            asset.pixels = nullptr;
+            asset.pack.reset();
+            asset.texture = resources.addTexture(asset.file, std::move(asset.uploading));
+            std::lock_guard<std::mutex> lock(mutex);
+            asset.state = AssetState::Ready;
+            uploadQueue.pop_front();
+            recordLocked("uploaded " + asset.file);
+        }
+
+        if (frameClock.getElapsedTime() >= budget)
+            return;
+    }
+}
+
+AssetState AssetLoader::getState(AssetHandle handle) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return assets[handle]->state;
+}
+
+bool AssetLoader::isIdle() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return busyJobs == 0 && uploadQueue.empty();
+}
+
+void AssetLoader::printTimeline(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    out << "Startup timeline (ms since launch):" << std::endl;
+    for (const TimelineEvent& event : timeline)
+        out << std::setw(8) << std::fixed << std::setprecision(1) << event.time.asMicroseconds() / 1000.0 << "  " << event.what << std::endl;
+}
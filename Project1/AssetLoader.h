@@ -0,0 +1,98 @@
+#ifndef ASSETLOADER_H
+#define ASSETLOADER_H
+
+#include <SFML/Graphics.hpp>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ResourceCache.h"
+
+enum class AssetState {
+    Queued,  // Waiting for or being decoded by a worker
+    Decoded, // Pixels in memory, waiting for upload
+    Ready,   // Texture uploaded
+    Failed
+};
+
+// Index of a texture requested from an AssetLoader
+typedef std::size_t AssetHandle;
+
+// Loads images off the render thread.
+// Worker threads decode files into sf::Image; update() runs on the render
+// thread and uploads decoded images a strip of rows at a time until the
+// frame's budget is spent, so a large background never stalls a frame.
+// Raw images in a mounted pack skip the workers and upload straight from
+// the mapping; encoded ones are decoded from the mapped bytes.
+// Finished textures are published to the resource cache under their path,
+// and a texture already cached is handed out without reading the file again.
+// Every step is stamped on a startup timeline measured from construction.
+class AssetLoader {
+public:
+    static const unsigned int UPLOAD_STRIP_ROWS = 64;
+
+    explicit AssetLoader(ResourceCache& resources, unsigned int workerCount = 0);
+    ~AssetLoader();
+
+    // Queue a texture; the handle stays valid for the loader's lifetime
+    AssetHandle loadTexture(const std::string& file);
+    // Run a CPU-only job (no GL calls) on a worker
+    std::future<bool> run(const std::string& name, std::function<bool()> job);
+
+    // Render thread: upload decoded images until budget is spent (always at least one strip)
+    void update(sf::Time budget);
+
+    AssetState getState(AssetHandle handle) const;
+    bool isReady(AssetHandle handle) const { return getState(handle) == AssetState::Ready; }
+    // Only valid once the handle is Ready
+    const sf::Texture& getTexture(AssetHandle handle) const { return *assets[handle]->texture; }
+    // Nothing queued, decoding or waiting for upload
+    bool isIdle() const;
+
+    void mark(const std::string& event);
+    void printTimeline(std::ostream& out) const;
+
+private:
+    struct Asset {
+        std::string file;
+        AssetState state; // Guarded by mutex
+        sf::Image image;
+        std::shared_ptr<const AssetPack> pack; // Keeps pixels valid when they point into a pack
+        const sf::Uint8* pixels;               // RGBA rows to upload, in image or pack
+        sf::Vector2u size;
+        std::shared_ptr<sf::Texture> uploading;
+        TextureHandle texture;
+        unsigned int uploadedRows;
+    };
+
+    struct TimelineEvent {
+        sf::Time time;
+        std::string what;
+    };
+
+    void workerLoop();
+    void recordLocked(const std::string& what);
+
+    // Assets are only added and read on the render thread; workers get a pointer to theirs
+    ResourceCache& resources;
+    std::vector<std::unique_ptr<Asset>> assets;
+    std::deque<AssetHandle> uploadQueue;
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::size_t busyJobs; // Queued plus running
+    bool stopping;
+    mutable std::mutex mutex;
+    std::condition_variable jobAvailable;
+
+    sf::Clock clock;
+    std::vector<TimelineEvent> timeline;
+};
+
+#endif // ASSETLOADER_H
@@ -0,0 +1,194 @@
+#include "AssetPack.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+bool isImageFile(const std::string& file) {
+    std::size_t dot = file.find_last_of('.');
+    if (dot == std::string::npos)
+        return false;
+    std::string extension = file.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return static_cast<char>(::tolower(c)); });
+    return extension == "png" || extension == "jpg" || extension == "jpeg" || extension == "bmp" || extension == "tga";
+}
+
+void padTo(std::ofstream& output, std::uint64_t alignment) {
+    static const char zeros[PACK_ALIGNMENT] = {};
+    std::uint64_t position = static_cast<std::uint64_t>(output.tellp());
+    std::uint64_t padding = (alignment - position % alignment) % alignment;
+    output.write(zeros, static_cast<std::streamsize>(padding));
+}
+
+} // namespace
+
+bool buildPack(const std::vector<PackSource>& sources, const std::string& packFile, bool rawImages) {
+    std::ofstream output(packFile, std::ios::binary | std::ios::trunc);
+    if (!output.is_open()) {
+        std::cerr << "Failed to write pack file: " << packFile << std::endl;
+        return false;
+    }
+
+    // Lookups binary-search the index, so entries are written in name order
+    std::vector<PackSource> sorted = sources;
+    std::sort(sorted.begin(), sorted.end(), [](const PackSource& a, const PackSource& b) { return a.name < b.name; });
+
+    PackHeader header;
+    std::memcpy(header.magic, PACK_FILE_MAGIC, sizeof(header.magic));
+    header.version = PACK_FILE_VERSION;
+    header.entryCount = static_cast<std::uint32_t>(sorted.size());
+    header.reserved = 0;
+    header.indexOffset = 0;
+    header.namesOffset = 0;
+    // Placeholder header; the offsets are known once the data is written
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<PackIndexEntry> index;
+    std::string names;
+    for (const PackSource& source : sorted) {
+        PackIndexEntry entry;
+        entry.nameOffset = static_cast<std::uint32_t>(names.size());
+        entry.nameLength = static_cast<std::uint32_t>(source.name.size());
+        entry.width = 0;
+        entry.height = 0;
+        entry.reserved = 0;
+        names += source.name;
+
+        padTo(output, PACK_ALIGNMENT);
+        entry.offset = static_cast<std::uint64_t>(output.tellp());
+
+        sf::Image image;
+        if (rawImages && isImageFile(source.file)) {
+            if (!image.loadFromFile(source.file)) {
+                std::cerr << "Failed to decode image for pack: " << source.file << std::endl;
+                return false;
+            }
+            entry.format = PackFormat::RawRgba;
+            entry.width = image.getSize().x;
+            entry.height = image.getSize().y;
+            entry.size = static_cast<std::uint64_t>(entry.width) * entry.height * 4;
+            output.write(reinterpret_cast<const char*>(image.getPixelsPtr()), static_cast<std::streamsize>(entry.size));
+        }
+        else {
+            std::ifstream input(source.file, std::ios::binary);
+            if (!input.is_open()) {
+                std::cerr << "Failed to open file for pack: " << source.file << std::endl;
+                return false;
+            }
+            entry.format = PackFormat::File;
+            // Streaming an empty rdbuf sets failbit on the output, so a zero-byte
+            // file is written as an empty entry without copying
+            if (input.peek() != std::ifstream::traits_type::eof())
+                output << input.rdbuf();
+            entry.size = static_cast<std::uint64_t>(output.tellp()) - entry.offset;
+        }
+        index.push_back(entry);
+    }
+
+    padTo(output, PACK_ALIGNMENT);
+    header.indexOffset = static_cast<std::uint64_t>(output.tellp());
+    output.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(PackIndexEntry)));
+    header.namesOffset = static_cast<std::uint64_t>(output.tellp());
+    output.write(names.data(), static_cast<std::streamsize>(names.size()));
+
+    output.seekp(0);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    return static_cast<bool>(output);
+}
+
+bool AssetPack::open(const std::string& path) {
+    if (!file.open(path))
+        return false;
+
+    if (file.size() < sizeof(PackHeader) || std::memcmp(header().magic, PACK_FILE_MAGIC, sizeof(PACK_FILE_MAGIC)) != 0
+        || header().version != PACK_FILE_VERSION || header().indexOffset % PACK_ALIGNMENT != 0) {
+        std::cerr << "Not an asset pack: " << path << std::endl;
+        file.close();
+        return false;
+    }
+    if (header().indexOffset > file.size() || header().namesOffset > file.size()
+        || (file.size() - header().indexOffset) / sizeof(PackIndexEntry) < header().entryCount) {
+        std::cerr << "Truncated asset pack: " << path << std::endl;
+        file.close();
+        return false;
+    }
+
+    // Validate every entry once so lookups can trust the index
+    std::uint64_t namesSize = file.size() - header().namesOffset;
+    for (std::uint32_t i = 0; i < header().entryCount; ++i) {
+        const PackIndexEntry& entry = index()[i];
+        if (entry.offset > file.size() || entry.size > file.size() - entry.offset
+            || entry.nameOffset > namesSize || entry.nameLength > namesSize - entry.nameOffset
+            || (entry.format == PackFormat::RawRgba && entry.size != static_cast<std::uint64_t>(entry.width) * entry.height * 4)) {
+            std::cerr << "Corrupt asset pack entry " << i << " in " << path << std::endl;
+            file.close();
+            return false;
+        }
+    }
+    return true;
+}
+
+const PackIndexEntry* AssetPack::find(const std::string& name) const {
+    if (!file.isOpen())
+        return nullptr;
+
+    const PackIndexEntry* first = index();
+    const PackIndexEntry* last = first + header().entryCount;
+    const char* nameTable = names();
+    const PackIndexEntry* it = std::lower_bound(first, last, name, [nameTable](const PackIndexEntry& entry, const std::string& key) {
+        return key.compare(0, std::string::npos, nameTable + entry.nameOffset, entry.nameLength) > 0;
+    });
+    if (it == last || name.compare(0, std::string::npos, nameTable + it->nameOffset, it->nameLength) != 0)
+        return nullptr;
+    return it;
+}
+
+bool AssetPack::loadImage(const std::string& name, sf::Image& image) const {
+    const PackIndexEntry* entry = find(name);
+    if (!entry)
+        return false;
+    if (entry->format == PackFormat::RawRgba) {
+        image.create(entry->width, entry->height, static_cast<const sf::Uint8*>(data(*entry)));
+        return true;
+    }
+    return image.loadFromMemory(data(*entry), static_cast<std::size_t>(entry->size));
+}
+
+bool AssetPack::loadTexture(const std::string& name, sf::Texture& texture) const {
+    const PackIndexEntry* entry = find(name);
+    if (!entry)
+        return false;
+    if (entry->format == PackFormat::RawRgba) {
+        // Straight from the mapped pages to the GPU, no sf::Image in between
+        if (!texture.create(entry->width, entry->height))
+            return false;
+        texture.update(static_cast<const sf::Uint8*>(data(*entry)));
+        return true;
+    }
+    return texture.loadFromMemory(data(*entry), static_cast<std::size_t>(entry->size));
+}
+
+bool AssetPack::loadFont(const std::string& name, sf::Font& font) const {
+    // sf::Font reads glyphs from this memory for as long as it lives
+    const PackIndexEntry* entry = find(name);
+    return entry && entry->format == PackFormat::File && font.loadFromMemory(data(*entry), static_cast<std::size_t>(entry->size));
+}
+
+bool AssetPack::openStream(const std::string& name, sf::MemoryInputStream& stream) const {
+    const PackIndexEntry* entry = find(name);
+    if (!entry || entry->format != PackFormat::File)
+        return false;
+    stream.open(data(*entry), static_cast<std::size_t>(entry->size));
+    return true;
+}
+
+bool AssetPack::readText(const std::string& name, std::string& text) const {
+    const PackIndexEntry* entry = find(name);
+    if (!entry || entry->format != PackFormat::File)
+        return false;
+    text.assign(static_cast<const char*>(data(*entry)), static_cast<std::size_t>(entry->size));
+    return true;
+}
@@ -0,0 +1,86 @@
+#ifndef ASSETPACK_H
+#define ASSETPACK_H
+
+#include <SFML/Graphics.hpp>
+#include <SFML/System/MemoryInputStream.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+// Asset archive layout (little-endian):
+//   PackHeader
+//   entry data, each blob aligned to PACK_ALIGNMENT
+//   entryCount PackIndexEntry records, sorted by name
+//   name table (names are not NUL-terminated)
+// Blobs are either the original file bytes or, for images built with raw
+// pixels, width * height RGBA8 texels that go to the GPU without decoding.
+struct PackHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t entryCount;
+    std::uint32_t reserved;
+    std::uint64_t indexOffset;
+    std::uint64_t namesOffset;
+};
+
+enum class PackFormat : std::uint32_t {
+    File,     // Original bytes, decoded by the SFML loaders
+    RawRgba   // Pre-decoded RGBA8 pixels
+};
+
+struct PackIndexEntry {
+    std::uint64_t offset;
+    std::uint64_t size;
+    std::uint32_t nameOffset;
+    std::uint32_t nameLength;
+    PackFormat format;
+    std::uint32_t width;  // Raw images only
+    std::uint32_t height;
+    std::uint32_t reserved;
+};
+
+const char PACK_FILE_MAGIC[4] = { 'F', 'P', 'P', 'K' };
+const std::uint32_t PACK_FILE_VERSION = 1;
+const std::uint64_t PACK_ALIGNMENT = 16;
+
+// One file to store; the name is what the game asks for at runtime
+struct PackSource {
+    std::string name;
+    std::string file;
+};
+
+// Writes every source into one archive. With rawImages, PNG/JPG/BMP/TGA
+// files are decoded once here and stored as RGBA pixels.
+bool buildPack(const std::vector<PackSource>& sources, const std::string& packFile, bool rawImages);
+
+// Memory-mapped archive. Loaders read straight out of the mapping: raw
+// images are uploaded from it, fonts keep pointing into it, and encoded
+// files go through loadFromMemory or a MemoryInputStream over the blob.
+// Everything loaded from the pack must be released before it is closed.
+class AssetPack {
+public:
+    bool open(const std::string& path);
+
+    bool contains(const std::string& name) const { return find(name) != nullptr; }
+    const PackIndexEntry* find(const std::string& name) const;
+    const void* data(const PackIndexEntry& entry) const { return file.data() + entry.offset; }
+    std::size_t entryCount() const { return file.isOpen() ? header().entryCount : 0; }
+
+    // Each returns false when the name is missing or the data does not load
+    bool loadImage(const std::string& name, sf::Image& image) const;
+    bool loadTexture(const std::string& name, sf::Texture& texture) const;
+    bool loadFont(const std::string& name, sf::Font& font) const;
+    bool openStream(const std::string& name, sf::MemoryInputStream& stream) const;
+    // Manifest and other text entries
+    bool readText(const std::string& name, std::string& text) const;
+
+private:
+    const PackHeader& header() const { return *reinterpret_cast<const PackHeader*>(file.data()); }
+    const PackIndexEntry* index() const { return reinterpret_cast<const PackIndexEntry*>(file.data() + header().indexOffset); }
+    const char* names() const { return reinterpret_cast<const char*>(file.data() + header().namesOffset); }
+
+    MappedFile file;
+};
+
+#endif // ASSETPACK_H
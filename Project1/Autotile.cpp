@@ -0,0 +1,84 @@
+#include "Autotile.h"
+#include <algorithm>
+#include <thread>
+
+// Rows below this are not worth a thread of their own
+const int MIN_ROWS_PER_BAND = 64;
+
+AutotileLayer::AutotileLayer(const Tileset& tileset, int width, int height)
+    : tileset(tileset),
+      width(width),
+      height(height),
+      cells(static_cast<std::size_t>(width) * height, 0),
+      tiles(static_cast<std::size_t>(width) * height, tileset.getEmptyTile()) {
+}
+
+bool AutotileLayer::getCell(int x, int y) const {
+    if (x < 0 || y < 0 || x >= width || y >= height)
+        return true;
+    return cells[static_cast<std::size_t>(y) * width + x] != 0;
+}
+
+std::uint16_t AutotileLayer::resolveCell(int x, int y) const {
+    if (!getCell(x, y))
+        return tileset.getEmptyTile();
+
+    std::uint8_t mask = 0;
+    if (getCell(x, y - 1)) mask |= NEIGHBOUR_N;
+    if (getCell(x + 1, y - 1)) mask |= NEIGHBOUR_NE;
+    if (getCell(x + 1, y)) mask |= NEIGHBOUR_E;
+    if (getCell(x + 1, y + 1)) mask |= NEIGHBOUR_SE;
+    if (getCell(x, y + 1)) mask |= NEIGHBOUR_S;
+    if (getCell(x - 1, y + 1)) mask |= NEIGHBOUR_SW;
+    if (getCell(x - 1, y)) mask |= NEIGHBOUR_W;
+    if (getCell(x - 1, y - 1)) mask |= NEIGHBOUR_NW;
+    return tileset.tileForMask(mask);
+}
+
+void AutotileLayer::resolveRows(int firstRow, int endRow) {
+    for (int y = firstRow; y < endRow; ++y) {
+        for (int x = 0; x < width; ++x)
+            tiles[static_cast<std::size_t>(y) * width + x] = resolveCell(x, y);
+    }
+}
+
+void AutotileLayer::setTerrain(const std::vector<std::uint8_t>& newCells, unsigned threadCount) {
+    cells = newCells;
+    cells.resize(static_cast<std::size_t>(width) * height, 0);
+    changedCells.clear();
+
+    // Bands only read the shared occupancy grid and write their own rows
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    int bands = std::max(1, std::min(static_cast<int>(threadCount), height / MIN_ROWS_PER_BAND));
+    int rowsPerBand = (height + bands - 1) / bands;
+
+    std::vector<std::thread> workers;
+    for (int band = 1; band < bands; ++band) {
+        int first = band * rowsPerBand;
+        workers.emplace_back(&AutotileLayer::resolveRows, this, first, std::min(height, first + rowsPerBand));
+    }
+    resolveRows(0, std::min(height, rowsPerBand));
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+int AutotileLayer::setCell(int x, int y, bool filled) {
+    changedCells.clear();
+    if (x < 0 || y < 0 || x >= width || y >= height || getCell(x, y) == filled)
+        return 0;
+    cells[static_cast<std::size_t>(y) * width + x] = filled ? 1 : 0;
+
+    // Only the cell and its eight neighbours can see the change
+    for (int ny = std::max(0, y - 1); ny <= std::min(height - 1, y + 1); ++ny) {
+        for (int nx = std::max(0, x - 1); nx <= std::min(width - 1, x + 1); ++nx) {
+            int offset = ny * width + nx;
+            std::uint16_t tile = resolveCell(nx, ny);
+            if (tiles[offset] != tile) {
+                tiles[offset] = tile;
+                changedCells.push_back(offset);
+            }
+        }
+    }
+    return static_cast<int>(changedCells.size());
+}
@@ -0,0 +1,41 @@
+#ifndef AUTOTILE_H
+#define AUTOTILE_H
+
+#include "Tileset.h"
+#include <cstdint>
+#include <vector>
+
+// Terrain occupancy resolved to tile indices through a Tileset's bitmask table.
+// The full resolve runs once at load time in parallel row bands; the result
+// is cached, and editing one cell only re-resolves its 3x3 neighbourhood.
+// Cells outside the map count as terrain so edges do not grow a border.
+class AutotileLayer {
+public:
+    AutotileLayer(const Tileset& tileset, int width, int height);
+
+    // Replace the occupancy grid (width * height cells, non-zero = terrain) and resolve it
+    void setTerrain(const std::vector<std::uint8_t>& cells, unsigned threadCount = 0);
+    // Edit one cell; returns how many of the up to nine cached tiles changed.
+    // The changed cells are listed by getChangedCells() until the next edit.
+    int setCell(int x, int y, bool filled);
+    bool getCell(int x, int y) const;
+
+    std::uint16_t getTile(int x, int y) const { return tiles[static_cast<std::size_t>(y) * width + x]; }
+    const std::vector<std::uint16_t>& getTiles() const { return tiles; }
+    const std::vector<int>& getChangedCells() const { return changedCells; } // Flat y * width + x
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+private:
+    std::uint16_t resolveCell(int x, int y) const;
+    void resolveRows(int firstRow, int endRow);
+
+    const Tileset& tileset;
+    int width;
+    int height;
+    std::vector<std::uint8_t> cells;
+    std::vector<std::uint16_t> tiles;
+    std::vector<int> changedCells;
+};
+
+#endif // AUTOTILE_H
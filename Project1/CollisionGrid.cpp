@@ -0,0 +1,103 @@
+#include "CollisionGrid.h"
+#include <algorithm>
+#include <cmath>
+#include "SimdKernels.h"
+
+CollisionGrid::CollisionGrid(float worldWidth, float worldHeight, float cellSize)
+    : cellSize(cellSize),
+      columns(std::max(1, static_cast<int>(std::ceil(worldWidth / cellSize)))),
+      rows(std::max(1, static_cast<int>(std::ceil(worldHeight / cellSize)))),
+      maxBoxWidth(0.0f),
+      maxBoxHeight(0.0f),
+      cellStart(static_cast<std::size_t>(columns) * rows + 1, 0) {
+}
+
+// Items outside the world are clamped into the border cells; queries clamp the same way
+int CollisionGrid::cellColumn(float x) const {
+    int column = static_cast<int>(std::floor(x / cellSize));
+    return std::max(0, std::min(columns - 1, column));
+}
+
+int CollisionGrid::cellRow(float y) const {
+    int row = static_cast<int>(std::floor(y / cellSize));
+    return std::max(0, std::min(rows - 1, row));
+}
+
+void CollisionGrid::rebuild(const ItemPool& pool, const ItemKindInfo* kinds) {
+    std::size_t count = pool.size();
+    if (itemCell.size() < count) {
+        itemCell.resize(pool.capacity());
+        boxLeft.resize(pool.capacity());
+        boxTop.resize(pool.capacity());
+        boxRight.resize(pool.capacity());
+        boxBottom.resize(pool.capacity());
+        boxItem.resize(pool.capacity());
+        hitMask.resize((pool.capacity() + 7) / 8);
+    }
+
+    maxBoxWidth = 0.0f;
+    maxBoxHeight = 0.0f;
+    for (int k = 0; k < static_cast<int>(ItemKind::Count); ++k) {
+        maxBoxWidth = std::max(maxBoxWidth, kinds[k].width - 2 * kinds[k].collisionInset);
+        maxBoxHeight = std::max(maxBoxHeight, kinds[k].height - 2 * kinds[k].collisionInset);
+    }
+
+    // Count items per cell
+    std::fill(cellStart.begin(), cellStart.end(), 0u);
+    for (std::size_t i = 0; i < count; ++i) {
+        const ItemKindInfo& info = kinds[static_cast<int>(pool.kind[i])];
+        int cell = cellRow(pool.posY[i] + info.collisionInset) * columns + cellColumn(pool.posX[i] + info.collisionInset);
+        itemCell[i] = static_cast<std::uint32_t>(cell);
+        ++cellStart[cell + 1];
+    }
+
+    // Prefix sum turns counts into start offsets
+    for (std::size_t c = 1; c < cellStart.size(); ++c)
+        cellStart[c] += cellStart[c - 1];
+
+    // Scatter the collision boxes into cell order; cellStart[c] is the write
+    // cursor for cell c, so afterwards it holds that cell's end offset
+    for (std::size_t i = 0; i < count; ++i) {
+        const ItemKindInfo& info = kinds[static_cast<int>(pool.kind[i])];
+        std::uint32_t slot = cellStart[itemCell[i]]++;
+        boxLeft[slot] = pool.posX[i] + info.collisionInset;
+        boxTop[slot] = pool.posY[i] + info.collisionInset;
+        boxRight[slot] = pool.posX[i] + info.width - info.collisionInset;
+        boxBottom[slot] = pool.posY[i] + info.height - info.collisionInset;
+        boxItem[slot] = static_cast<std::uint32_t>(i);
+    }
+
+    // Shift the cursors back so cellStart[c] is the start of cell c again
+    for (std::size_t c = cellStart.size() - 1; c > 0; --c)
+        cellStart[c] = cellStart[c - 1];
+    cellStart[0] = 0;
+}
+
+void CollisionGrid::query(float left, float top, float right, float bottom, std::vector<std::uint32_t>& hits) {
+    // A box binned by its top-left corner can reach back at most one box size
+    int firstColumn = cellColumn(left - maxBoxWidth);
+    int lastColumn = cellColumn(right);
+    int firstRow = cellRow(top - maxBoxHeight);
+    int lastRow = cellRow(bottom);
+
+    for (int row = firstRow; row <= lastRow; ++row) {
+        // Cells of one row are contiguous, so scan the whole column span at once
+        std::uint32_t begin = cellStart[row * columns + firstColumn];
+        std::uint32_t end = cellStart[row * columns + lastColumn + 1];
+        std::size_t span = end - begin;
+        if (span == 0)
+            continue;
+
+        // Batch-test the span, then only walk the set bits of the hit mask
+        if (testBoxes(&boxLeft[begin], &boxTop[begin], &boxRight[begin], &boxBottom[begin], span, left, top, right, bottom, hitMask.data()) == 0)
+            continue;
+        for (std::size_t byte = 0; byte < (span + 7) / 8; ++byte) {
+            for (unsigned bits = hitMask[byte]; bits != 0; bits &= bits - 1) {
+                std::size_t bit = 0;
+                while (!(bits & (1u << bit)))
+                    ++bit;
+                hits.push_back(boxItem[begin + byte * 8 + bit]);
+            }
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef COLLISIONGRID_H
+#define COLLISIONGRID_H
+
+#include <cstdint>
+#include <vector>
+#include "ItemPool.h"
+
+// Uniform-grid broadphase for item collisions.
+// Rebuilt once per tick with a counting sort: every item is binned by the
+// cell holding its top-left corner, and its collision box is computed once
+// and stored in cell order. A query only visits the cells its box can reach,
+// so per-player cost depends on local density instead of the live item count.
+class CollisionGrid {
+public:
+    CollisionGrid(float worldWidth, float worldHeight, float cellSize);
+
+    void rebuild(const ItemPool& pool, const ItemKindInfo* kinds);
+
+    // Appends the pool indices of items whose collision box overlaps the query box
+    void query(float left, float top, float right, float bottom, std::vector<std::uint32_t>& hits);
+
+    std::size_t cellCount() const { return cellStart.size() - 1; }
+
+private:
+    int cellColumn(float x) const;
+    int cellRow(float y) const;
+
+    float cellSize;
+    int columns;
+    int rows;
+    float maxBoxWidth;  // Largest collision box seen in the last rebuild; widens queries
+    float maxBoxHeight;
+
+    std::vector<std::uint32_t> cellStart; // Offsets into the cell-ordered arrays, one extra at the end
+    std::vector<std::uint32_t> itemCell;  // Cell of each pool item, scratch for the counting sort
+
+    // Collision boxes in cell order
+    std::vector<float> boxLeft;
+    std::vector<float> boxTop;
+    std::vector<float> boxRight;
+    std::vector<float> boxBottom;
+    std::vector<std::uint32_t> boxItem;
+
+    std::vector<std::uint8_t> hitMask; // Scratch for the batch box test
+};
+
+#endif // COLLISIONGRID_H
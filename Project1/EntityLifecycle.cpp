@@ -0,0 +1,58 @@
+#include "EntityLifecycle.h"
+
+EntityLifecycle::EntityLifecycle(std::size_t initialCapacity)
+    : nextId(0), recycled(0) {
+    denseIndexOf.reserve(initialCapacity);
+    generation.reserve(initialCapacity);
+    freeIds.reserve(initialCapacity);
+}
+
+EntityHandle EntityLifecycle::acquire(std::uint32_t denseIndex) {
+    std::uint32_t id;
+    if (!freeIds.empty()) {
+        // Recycle a retired id
+        id = freeIds.back();
+        freeIds.pop_back();
+        ++recycled;
+    }
+    else {
+        // Take a fresh id; arrays only grow past their previous high-water mark
+        id = nextId++;
+        if (id == denseIndexOf.size()) {
+            denseIndexOf.push_back(INVALID_ENTITY_INDEX);
+            generation.push_back(0);
+            freeIds.reserve(denseIndexOf.capacity());
+        }
+    }
+
+    // Every reuse of an id invalidates handles to its previous owner
+    ++generation[id];
+    denseIndexOf[id] = denseIndex;
+    return { id, generation[id] };
+}
+
+void EntityLifecycle::release(std::uint32_t id) {
+    denseIndexOf[id] = INVALID_ENTITY_INDEX;
+    freeIds.push_back(id);
+}
+
+void EntityLifecycle::relocate(std::uint32_t id, std::uint32_t denseIndex) {
+    denseIndexOf[id] = denseIndex;
+}
+
+void EntityLifecycle::reset() {
+    // Ids below nextId are the only ones considered live, so dropping the
+    // free list and the high-water mark retires everything at once
+    freeIds.clear();
+    nextId = 0;
+}
+
+bool EntityLifecycle::isAlive(EntityHandle handle) const {
+    return handle.id < nextId
+        && generation[handle.id] == handle.generation
+        && denseIndexOf[handle.id] != INVALID_ENTITY_INDEX;
+}
+
+std::uint32_t EntityLifecycle::indexOf(EntityHandle handle) const {
+    return isAlive(handle) ? denseIndexOf[handle.id] : INVALID_ENTITY_INDEX;
+}
@@ -0,0 +1,48 @@
+#ifndef ENTITYLIFECYCLE_H
+#define ENTITYLIFECYCLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Stable reference to a pooled entity; stays valid until the entity retires
+struct EntityHandle {
+    std::uint32_t id;
+    std::uint32_t generation;
+};
+
+const std::uint32_t INVALID_ENTITY_INDEX = 0xFFFFFFFFu;
+
+// Hands out entity ids and maps them to dense pool slots.
+// Retired ids go onto a free list and are reused with a bumped generation,
+// so stale handles are detected and the id space never grows past the
+// largest number of entities alive at once. reset() is O(1): it forgets
+// every live id without touching the per-id arrays.
+class EntityLifecycle {
+public:
+    explicit EntityLifecycle(std::size_t initialCapacity);
+
+    EntityHandle acquire(std::uint32_t denseIndex);
+    void release(std::uint32_t id);
+    void relocate(std::uint32_t id, std::uint32_t denseIndex);
+    void reset();
+
+    bool isAlive(EntityHandle handle) const;
+    std::uint32_t indexOf(EntityHandle handle) const;
+    // Current generation of a live id, to tell a recycled id from the entity that had it before
+    std::uint32_t generationOf(std::uint32_t id) const { return generation[id]; }
+
+    // Number of ids ever in use since the last reset (bounded by peak live count)
+    std::size_t highWater() const { return nextId; }
+    // Number of acquisitions served from the free list
+    std::uint64_t recycledCount() const { return recycled; }
+
+private:
+    std::vector<std::uint32_t> denseIndexOf;
+    std::vector<std::uint32_t> generation;
+    std::vector<std::uint32_t> freeIds;
+    std::uint32_t nextId;
+    std::uint64_t recycled;
+};
+
+#endif // ENTITYLIFECYCLE_H
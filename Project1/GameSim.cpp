@@ -0,0 +1,234 @@
+#include "GameSim.h"
+#include <algorithm>
+#include "SimdKernels.h"
+#include "Profiler.h"
+
+// Initial number of item slots; the pool only grows past this under stress
+const std::size_t ITEM_POOL_CAPACITY = 1024;
+
+GameSim::GameSim(const GameSimConfig& config)
+    : config(config),
+      random(config.seed),
+      players(std::max(1, std::min(config.playerCount, MAX_SIM_PLAYERS))),
+      itemPool(config.itemPoolCapacity),
+      collisionGrid(static_cast<float>(WINDOW_WIDTH), static_cast<float>(WINDOW_HEIGHT), COLLISION_CELL_SIZE) {
+    for (PlayerState& player : players)
+        player.active = true;
+    reset();
+}
+
+GameSimConfig GameSim::defaultConfig() {
+    GameSimConfig config;
+    // Apples collide with their whole sprite and are worth SCORE_PER_FRUIT points
+    config.itemKinds[static_cast<int>(ItemKind::Apple)] = { DEFAULT_ITEM_SIZE, DEFAULT_ITEM_SIZE, 0.0f, SCORE_PER_FRUIT };
+    // Bomb collision bounds are reduced by COLLISION_REDUCTION pixels on each side
+    config.itemKinds[static_cast<int>(ItemKind::Bomb)] = { DEFAULT_ITEM_SIZE, DEFAULT_ITEM_SIZE, COLLISION_REDUCTION, SCORE_PER_BOMB };
+    config.playerWidth = FRAME_WIDTH * PLAYER_SCALE;
+    config.playerHeight = FRAME_HEIGHT * PLAYER_SCALE;
+    config.seed = 1;
+    config.itemPoolCapacity = ITEM_POOL_CAPACITY;
+    config.playerCount = 1;
+    return config;
+}
+
+void GameSim::resetPlayer(int index) {
+    // Adjust starting position to the bottom of the window; one player starts in the middle
+    PlayerState& player = players[index];
+    player.posX = (WINDOW_WIDTH - PLAYER_WIDTH) * (index + 1) / (players.size() + 1);
+    player.posY = WINDOW_HEIGHT - PLAYER_HEIGHT;
+    player.prevPosX = player.posX;
+    player.velocityX = 0.0f;
+    player.currentFrame = PLAYER_FRAME_NEUTRAL;
+    player.score = 0;
+    player.out = false;
+}
+
+void GameSim::reset() {
+    for (int i = 0; i < playerCount(); ++i)
+        resetPlayer(i);
+
+    itemPool.clear();
+    timeSinceLastFruitSpawn = 0.0f;
+    timeSinceLastBombSpawn = 0.0f;
+    gameOver = false;
+    ticks = 0;
+}
+
+void GameSim::setPlayerActive(int index, bool active) {
+    if (active && !players[index].active)
+        resetPlayer(index);
+    players[index].active = active;
+
+    gameOver = true;
+    for (const PlayerState& player : players)
+        gameOver = gameOver && (!player.active || player.out);
+}
+
+void GameSim::step(float deltaTime, const InputState* inputs) {
+    if (gameOver)
+        return;
+
+    updatePlayers(deltaTime, inputs);
+    spawnItems(deltaTime);
+    resolveCollisions();
+    updateItems(deltaTime);
+    ++ticks;
+}
+
+namespace {
+
+// FNV-1a over raw bytes; floats are hashed bit for bit
+void hashBytes(std::uint32_t& hash, const void* data, std::size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+}
+
+} // namespace
+
+std::uint32_t GameSim::checksum() const {
+    std::uint32_t hash = 2166136261u;
+    for (const PlayerState& player : players)
+        hashBytes(hash, &player.score, sizeof(player.score));
+    hashBytes(hash, &ticks, sizeof(ticks));
+    for (const PlayerState& player : players)
+        hashBytes(hash, &player.posX, sizeof(player.posX));
+    std::size_t count = itemPool.size();
+    hashBytes(hash, &count, sizeof(count));
+    hashBytes(hash, itemPool.posX.data(), count * sizeof(float));
+    hashBytes(hash, itemPool.posY.data(), count * sizeof(float));
+    return hash;
+}
+
+void GameSim::updatePlayers(float deltaTime, const InputState* inputs) {
+    PROFILE_SCOPE(ProfilePhase::Player);
+
+    for (std::size_t i = 0; i < players.size(); ++i) {
+        PlayerState& player = players[i];
+        const InputState& input = inputs[i];
+        if (!player.active || player.out)
+            continue;
+
+        // Player movement
+        if (input.left)
+            player.velocityX = -PLAYER_SPEED;
+        else if (input.right)
+            player.velocityX = PLAYER_SPEED;
+        else
+            player.velocityX = 0;
+
+        // Update player position while keeping it within bounds
+        player.prevPosX = player.posX;
+        float nextX = player.posX + player.velocityX * deltaTime;
+        player.posX = std::max(0.0f, std::min(WINDOW_WIDTH - PLAYER_WIDTH, nextX));
+
+        // Update animation frame based on velocity
+        if (player.velocityX < 0)
+            player.currentFrame = PLAYER_FRAME_LEFT;
+        else if (player.velocityX > 0)
+            player.currentFrame = PLAYER_FRAME_RIGHT;
+        else
+            player.currentFrame = PLAYER_FRAME_NEUTRAL;
+    }
+}
+
+void GameSim::spawnItems(float deltaTime) {
+    PROFILE_SCOPE(ProfilePhase::Spawn);
+
+    // Spawn fruits from the top with random X positions across multiple lines
+    timeSinceLastFruitSpawn += deltaTime;
+    if (timeSinceLastFruitSpawn > FRUIT_SPAWN_INTERVAL) {
+        for (int i = 0; i < 2; ++i) { // Reduce the number of lines
+            float posX = static_cast<float>(random.range(WINDOW_WIDTH - 200) + 100); // Random X position across the screen (avoiding edges)
+            float posY = 50.0f * (i + 1); // Start above the screen, increment Y for each line
+            itemPool.spawn(ItemKind::Apple, posX, posY);
+        }
+        timeSinceLastFruitSpawn = 0.0f;
+    }
+
+    // Spawn bombs from the top with random X positions across multiple lines
+    timeSinceLastBombSpawn += deltaTime;
+    if (timeSinceLastBombSpawn > BOMB_SPAWN_INTERVAL) {
+        for (int i = 0; i < NUM_BOMBS; ++i) {
+            float posX = static_cast<float>(random.range(WINDOW_WIDTH - 200) + 100);
+            float posY = 50.0f * (i + 1);
+            itemPool.spawn(ItemKind::Bomb, posX, posY);
+        }
+        timeSinceLastBombSpawn = 0.0f;
+    }
+}
+
+void GameSim::resolveCollisions() {
+    PROFILE_SCOPE(ProfilePhase::Collision);
+
+    // With few players or items one pass over the items is cheaper than
+    // rebuilding the grid; hits are the same either way
+    std::size_t playersIn = 0;
+    for (const PlayerState& player : players)
+        playersIn += player.active && !player.out ? 1 : 0;
+    bool scan = playersIn <= static_cast<std::size_t>(COLLISION_SCAN_MAX_PLAYERS)
+        || itemPool.size() * playersIn <= COLLISION_SCAN_MAX_PAIRS;
+    // Item bounds are computed once per tick while binning them into the grid
+    if (!scan)
+        collisionGrid.rebuild(itemPool, config.itemKinds);
+
+    // Only items in cells overlapping a player are narrow-phase tested
+    bool anyPlayerIn = false;
+    for (PlayerState& player : players) {
+        if (!player.active || player.out)
+            continue;
+        float playerLeft = player.posX;
+        float playerTop = player.posY;
+        collisionHits.clear();
+        if (scan)
+            scanItems(playerLeft, playerTop, playerLeft + config.playerWidth, playerTop + config.playerHeight, collisionHits);
+        else
+            collisionGrid.query(playerLeft, playerTop, playerLeft + config.playerWidth, playerTop + config.playerHeight, collisionHits);
+
+        for (std::uint32_t i : collisionHits) {
+            const ItemKindInfo& info = config.itemKinds[static_cast<int>(itemPool.kind[i])];
+            if (itemPool.kind[i] == ItemKind::Bomb) {
+                // Out until the next round
+                player.out = true;
+            }
+            else if (!(itemPool.flags[i] & ITEM_FLAG_COLLECTED)) {
+                itemPool.flags[i] |= ITEM_FLAG_COLLECTED;
+                player.score += info.points;
+            }
+        }
+        anyPlayerIn = anyPlayerIn || !player.out;
+    }
+
+    // Game over
+    if (!anyPlayerIn)
+        gameOver = true;
+}
+
+void GameSim::scanItems(float left, float top, float right, float bottom, std::vector<std::uint32_t>& hits) const {
+    // Same bounds and overlap rule as CollisionGrid
+    for (std::size_t i = 0; i < itemPool.size(); ++i) {
+        const ItemKindInfo& info = config.itemKinds[static_cast<int>(itemPool.kind[i])];
+        float itemLeft = itemPool.posX[i] + info.collisionInset;
+        float itemTop = itemPool.posY[i] + info.collisionInset;
+        float itemRight = itemPool.posX[i] + info.width - info.collisionInset;
+        float itemBottom = itemPool.posY[i] + info.height - info.collisionInset;
+        if (itemLeft < right && left < itemRight && itemTop < bottom && top < itemBottom)
+            hits.push_back(static_cast<std::uint32_t>(i));
+    }
+}
+
+void GameSim::updateItems(float deltaTime) {
+    PROFILE_SCOPE(ProfilePhase::Items);
+
+    // Update items (fruits and bombs); collected and off-screen items retire
+    // straight away so their slots are recycled instead of lingering
+    integratePositions(itemPool.posY.data(), itemPool.prevPosY.data(), itemPool.size(), ITEM_SPEED * deltaTime);
+    for (std::size_t i = 0; i < itemPool.size();) {
+        if ((itemPool.flags[i] & ITEM_FLAG_COLLECTED) || itemPool.posY[i] > WINDOW_HEIGHT)
+            itemPool.remove(i);
+        else
+            ++i;
+    }
+}
@@ -0,0 +1,110 @@
+#ifndef GAMESIM_H
+#define GAMESIM_H
+
+#include <cstdint>
+#include "Global.hpp"
+#include <vector>
+#include "ItemPool.h"
+#include "CollisionGrid.h"
+
+// Buttons sampled by the front end for one tick
+struct InputState {
+    bool left;
+    bool right;
+};
+
+// Simulated player; the front end maps it onto a sprite
+struct PlayerState {
+    float posX;
+    float posY;
+    float prevPosX; // Position at the previous tick, for render interpolation
+    float velocityX;
+    int currentFrame; // Current frame index for animation
+    int score;
+    bool active; // Slot in use; inactive players are not simulated
+    bool out; // Hit a bomb; sits out until the next reset
+};
+
+// Players that can share one tree (network games; the local game has one)
+const int MAX_SIM_PLAYERS = 32;
+
+struct GameSimConfig {
+    ItemKindInfo itemKinds[static_cast<int>(ItemKind::Count)];
+    float playerWidth;  // Collision size of the player
+    float playerHeight;
+    std::uint32_t seed;
+    std::size_t itemPoolCapacity;
+    int playerCount; // Up to MAX_SIM_PLAYERS, spread out along the bottom
+};
+
+// Small deterministic PRNG (xorshift32) so a seed reproduces a whole session
+class SimRandom {
+public:
+    explicit SimRandom(std::uint32_t seed) : state(seed != 0 ? seed : 0x9E3779B9u) {}
+
+    std::uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // Uniform-ish integer in [0, bound)
+    int range(int bound) { return static_cast<int>(next() % static_cast<std::uint32_t>(bound)); }
+
+private:
+    std::uint32_t state;
+};
+
+// Headless gameplay: spawning, movement, collision and scoring.
+// Has no window, texture or clock dependency; the caller decides the tick
+// size and supplies the input, so the same inputs always give the same game.
+class GameSim {
+public:
+    explicit GameSim(const GameSimConfig& config);
+
+    // Config matching the shipped art, for runs without any textures
+    static GameSimConfig defaultConfig();
+
+    // Single player step; the input drives player 0
+    void step(float deltaTime, const InputState& input) { step(deltaTime, &input); }
+    // One input per player
+    void step(float deltaTime, const InputState* inputs);
+    // New round: every active player back in at its start position, score cleared
+    void reset();
+
+    int playerCount() const { return static_cast<int>(players.size()); }
+    const PlayerState& player(int index = 0) const { return players[index]; }
+    // Takes effect at once; a player activated mid-round starts at its start position
+    void setPlayerActive(int index, bool active);
+    const ItemPool& items() const { return itemPool; }
+    const ItemKindInfo& kindInfo(ItemKind kind) const { return config.itemKinds[static_cast<int>(kind)]; }
+    int score(int index = 0) const { return players[index].score; }
+    // The round is over once every active player is out
+    bool isGameOver() const { return gameOver; }
+    std::uint64_t tickCount() const { return ticks; }
+
+    // Hash of the player, score and items; equal runs give equal checksums
+    std::uint32_t checksum() const;
+
+private:
+    void resetPlayer(int index);
+    void updatePlayers(float deltaTime, const InputState* inputs);
+    void spawnItems(float deltaTime);
+    void resolveCollisions();
+    void scanItems(float left, float top, float right, float bottom, std::vector<std::uint32_t>& hits) const;
+    void updateItems(float deltaTime);
+
+    GameSimConfig config;
+    SimRandom random;
+    std::vector<PlayerState> players;
+    ItemPool itemPool;
+    CollisionGrid collisionGrid;
+    std::vector<std::uint32_t> collisionHits;
+    float timeSinceLastFruitSpawn;
+    float timeSinceLastBombSpawn;
+    bool gameOver;
+    std::uint64_t ticks;
+};
+
+#endif // GAMESIM_H
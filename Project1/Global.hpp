@@ -0,0 +1,53 @@
+#ifndef GLOBAL_HPP
+#define GLOBAL_HPP
+
+#include <cstddef>
+
+// Define constants
+const int WINDOW_WIDTH = 1920;
+const int WINDOW_HEIGHT = 1080;
+const float PLAYER_SPEED = 900.0f;
+const float ITEM_SPEED = 200.0f;
+const int NUM_BOMBS = 2;
+const float FRUIT_SPAWN_INTERVAL = 0.4f;
+const float BOMB_SPAWN_INTERVAL = 1.5f;
+const int SCORE_PER_FRUIT = 10;
+const int SCORE_PER_BOMB = -50;
+const float PLAYER_WIDTH = 150.0f;
+const float PLAYER_HEIGHT = 350.0f;
+const float COLLISION_REDUCTION = 10.0f;
+
+// Fixed simulation rate; rendering interpolates between ticks
+const int SIM_TICK_RATE = 120;
+const float SIM_TICK = 1.0f / SIM_TICK_RATE;
+const int MAX_SIM_STEPS_PER_FRAME = 8; // Catch-up cap so a long hitch cannot snowball
+
+// Redraw rate while a menu is open; the loop sleeps in between
+const int MENU_FRAME_RATE = 15;
+
+// Render-thread time per frame spent uploading textures that finished loading
+const float ASSET_UPLOAD_BUDGET = 0.002f;
+
+// Textures, fonts and sounds nobody holds are evicted above this many bytes
+const std::size_t RESOURCE_MEMORY_BUDGET = 256 * 1024 * 1024;
+
+// Define constants for animation
+const int FRAME_WIDTH = 24; // Width of each frame
+const int FRAME_HEIGHT = 24; // Height of each frame
+const int NUM_FRAMES = 3; // Number of frames in the animation (neutral, left, right)
+const float PLAYER_SCALE = 1.5f; // Scale applied to the player sprite
+const int PLAYER_FRAME_NEUTRAL = 0;
+const int PLAYER_FRAME_LEFT = 17;
+const int PLAYER_FRAME_RIGHT = 18;
+
+// Broadphase cell size; at least as large as any item so queries stay local
+const float COLLISION_CELL_SIZE = 128.0f;
+// Below these the items are scanned directly instead of rebuilding the grid
+// each tick (crossover measured with fruit_bench --filter collision)
+const int COLLISION_SCAN_MAX_PLAYERS = 2;
+const std::size_t COLLISION_SCAN_MAX_PAIRS = 4096; // Items times players
+
+// Size of the shipped item sprites, used when no textures are loaded (headless runs)
+const float DEFAULT_ITEM_SIZE = 60.0f;
+
+#endif // GLOBAL_HPP
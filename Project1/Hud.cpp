@@ -0,0 +1,115 @@
+#include "Hud.h"
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+// Every character the score line can contain
+const char HUD_CHARACTERS[] = "Score: -0123456789";
+const char SCORE_PREFIX[] = "Score: ";
+// "Score: -2147483648"
+const std::size_t MAX_SCORE_CHARACTERS = sizeof(SCORE_PREFIX) - 1 + 11;
+
+// Writes score as decimal into buffer without allocating, returns the length
+std::size_t formatScore(char* buffer, int score) {
+    std::size_t length = 0;
+    for (const char* c = SCORE_PREFIX; *c; ++c)
+        buffer[length++] = *c;
+
+    long long value = score;
+    if (value < 0) {
+        buffer[length++] = '-';
+        value = -value;
+    }
+    char digits[11];
+    std::size_t digitCount = 0;
+    do {
+        digits[digitCount++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (digitCount > 0)
+        buffer[length++] = digits[--digitCount];
+    return length;
+}
+
+} // namespace
+
+Hud::Hud()
+    : characterSize(24), color(sf::Color::White), score(0), loaded(false), vertexCount(0), stats{ 0 } {
+}
+
+bool Hud::load(ResourceCache& resources, const std::string& fontFile, unsigned int size) {
+    font = resources.getFont(fontFile);
+    if (!font)
+        return false;
+    characterSize = size;
+
+    // Rasterize the whole strip now so drawing never touches FreeType
+    for (const char* c = HUD_CHARACTERS; *c; ++c)
+        glyphs[static_cast<unsigned char>(*c)] = font->getGlyph(static_cast<sf::Uint32>(*c), characterSize, false);
+
+    vertices.resize(MAX_SCORE_CHARACTERS * 6);
+    loaded = true;
+    rebuild();
+    return true;
+}
+
+void Hud::setPosition(float x, float y) {
+    position = sf::Vector2f(x, y);
+    if (loaded)
+        rebuild();
+}
+
+void Hud::setScore(int newScore) {
+    if (newScore == score)
+        return;
+    score = newScore;
+    if (loaded)
+        rebuild();
+}
+
+void Hud::rebuild() {
+    char text[MAX_SCORE_CHARACTERS];
+    std::size_t length = formatScore(text, score);
+    ++stats.geometryRebuilds;
+
+    // Same layout as sf::Text: the baseline sits one character size below the top
+    float x = position.x;
+    float baseline = position.y + static_cast<float>(characterSize);
+    sf::Uint32 previous = 0;
+    vertexCount = 0;
+    for (std::size_t i = 0; i < length; ++i) {
+        sf::Uint32 current = static_cast<sf::Uint32>(text[i]);
+        x += font->getKerning(previous, current, characterSize);
+        previous = current;
+
+        const sf::Glyph& glyph = glyphs[static_cast<unsigned char>(text[i])];
+        float left = x + glyph.bounds.left;
+        float top = baseline + glyph.bounds.top;
+        float right = left + glyph.bounds.width;
+        float bottom = top + glyph.bounds.height;
+        float texLeft = static_cast<float>(glyph.textureRect.left);
+        float texTop = static_cast<float>(glyph.textureRect.top);
+        float texRight = static_cast<float>(glyph.textureRect.left + glyph.textureRect.width);
+        float texBottom = static_cast<float>(glyph.textureRect.top + glyph.textureRect.height);
+
+        sf::Vertex* quad = &vertices[vertexCount];
+        quad[0] = sf::Vertex(sf::Vector2f(left, top), color, sf::Vector2f(texLeft, texTop));
+        quad[1] = sf::Vertex(sf::Vector2f(right, top), color, sf::Vector2f(texRight, texTop));
+        quad[2] = sf::Vertex(sf::Vector2f(left, bottom), color, sf::Vector2f(texLeft, texBottom));
+        quad[3] = quad[2];
+        quad[4] = quad[1];
+        quad[5] = sf::Vertex(sf::Vector2f(right, bottom), color, sf::Vector2f(texRight, texBottom));
+        vertexCount += 6;
+
+        x += glyph.advance;
+    }
+}
+
+void Hud::draw(sf::RenderTarget& target) const {
+    if (!loaded || vertexCount == 0)
+        return;
+    sf::RenderStates states;
+    states.texture = &font->getTexture(characterSize);
+    target.draw(vertices.data(), vertexCount, sf::Triangles, states);
+}
@@ -0,0 +1,51 @@
+#ifndef HUD_H
+#define HUD_H
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ResourceCache.h"
+
+// Score display drawn from a pre-rasterized glyph strip.
+// The font comes from the resource cache in load(), the glyphs the HUD can show are
+// rasterized into the font page up front, and the score quads are only
+// rebuilt when the score actually changes, into storage reserved for the
+// longest possible string. The rebuild counter lets callers check that a
+// steady frame does not touch the geometry.
+class Hud {
+public:
+    struct Stats {
+        std::uint64_t geometryRebuilds;
+    };
+
+    Hud();
+
+    bool load(ResourceCache& resources, const std::string& fontFile, unsigned int characterSize);
+    void setPosition(float x, float y);
+    void setScore(int score);
+    void draw(sf::RenderTarget& target) const;
+
+    const sf::Font& getFont() const { return *font; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    void rebuild();
+
+    FontHandle font;
+    unsigned int characterSize;
+    sf::Vector2f position;
+    sf::Color color;
+    int score;
+    bool loaded;
+
+    // Glyphs the HUD can draw, indexed by character
+    static const int GLYPH_TABLE_SIZE = 128;
+    sf::Glyph glyphs[GLYPH_TABLE_SIZE];
+
+    std::vector<sf::Vertex> vertices;
+    std::size_t vertexCount;
+    Stats stats;
+};
+
+#endif // HUD_H
@@ -0,0 +1,123 @@
+#include "InputRecording.h"
+#include <cstring>
+#include <iostream>
+
+InputRecorder::InputRecorder() {
+    std::memset(&header, 0, sizeof(header));
+    std::memset(&run, 0, sizeof(run));
+}
+
+InputRecorder::~InputRecorder() {
+    // Keep what was recorded even if close() was never reached
+    if (output.is_open())
+        writeRun();
+}
+
+bool InputRecorder::open(const std::string& file, const GameSimConfig& config) {
+    output.open(file, std::ios::binary | std::ios::trunc);
+    if (!output.is_open()) {
+        std::cerr << "Failed to write recording: " << file << std::endl;
+        return false;
+    }
+
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, REPLAY_MAGIC, sizeof(header.magic));
+    header.version = REPLAY_VERSION;
+    header.tickRate = SIM_TICK_RATE;
+    header.seed = config.seed;
+    for (int kind = 0; kind < static_cast<int>(ItemKind::Count); ++kind)
+        header.itemKinds[kind] = config.itemKinds[kind];
+    header.playerWidth = config.playerWidth;
+    header.playerHeight = config.playerHeight;
+    header.itemPoolCapacity = config.itemPoolCapacity;
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::memset(&run, 0, sizeof(run));
+    return static_cast<bool>(output);
+}
+
+void InputRecorder::writeRun() {
+    if (run.ticks == 0 && !(run.flags & REPLAY_RESET))
+        return;
+    output.write(reinterpret_cast<const char*>(&run), sizeof(run));
+    // Pushed to the OS straight away so a crash or kill still leaves a usable file
+    output.flush();
+    std::memset(&run, 0, sizeof(run));
+}
+
+void InputRecorder::recordTick(const InputState& input) {
+    if (!output.is_open())
+        return;
+    std::uint8_t flags = (input.left ? REPLAY_LEFT : 0) | (input.right ? REPLAY_RIGHT : 0);
+    if (flags != run.flags || run.ticks == UINT32_MAX) {
+        writeRun();
+        run.flags = flags;
+    }
+    ++run.ticks;
+    ++header.totalTicks;
+}
+
+void InputRecorder::recordReset() {
+    if (!output.is_open())
+        return;
+    writeRun();
+    run.flags = REPLAY_RESET;
+    writeRun();
+}
+
+bool InputRecorder::close(const GameSim& sim) {
+    if (!output.is_open())
+        return false;
+    writeRun();
+    header.finalChecksum = sim.checksum();
+    header.complete = 1;
+    output.seekp(0);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    bool written = static_cast<bool>(output);
+    output.close();
+    return written;
+}
+
+bool InputReplay::open(const std::string& file) {
+    std::ifstream input(file, std::ios::binary);
+    if (!input.is_open()) {
+        std::cerr << "Failed to open recording: " << file << std::endl;
+        return false;
+    }
+
+    if (!input.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader))
+        || std::memcmp(fileHeader.magic, REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) != 0
+        || fileHeader.version != REPLAY_VERSION) {
+        std::cerr << "Not an input recording: " << file << std::endl;
+        return false;
+    }
+    if (fileHeader.tickRate != SIM_TICK_RATE) {
+        std::cerr << "Recording " << file << " was made at " << fileHeader.tickRate << " ticks per second, the game runs at " << SIM_TICK_RATE << std::endl;
+        return false;
+    }
+
+    // A partial trailing run is what a killed game leaves behind; it is dropped
+    fileRuns.clear();
+    ReplayRun run;
+    while (input.read(reinterpret_cast<char*>(&run), sizeof(run)))
+        fileRuns.push_back(run);
+    return true;
+}
+
+GameSimConfig InputReplay::config() const {
+    GameSimConfig config = GameSim::defaultConfig();
+    for (int kind = 0; kind < static_cast<int>(ItemKind::Count); ++kind)
+        config.itemKinds[kind] = fileHeader.itemKinds[kind];
+    config.playerWidth = fileHeader.playerWidth;
+    config.playerHeight = fileHeader.playerHeight;
+    config.seed = fileHeader.seed;
+    config.itemPoolCapacity = static_cast<std::size_t>(fileHeader.itemPoolCapacity);
+    return config;
+}
+
+InputState InputReplay::input(const ReplayRun& run) {
+    InputState input;
+    input.left = (run.flags & REPLAY_LEFT) != 0;
+    input.right = (run.flags & REPLAY_RIGHT) != 0;
+    return input;
+}
@@ -0,0 +1,88 @@
+#ifndef INPUTRECORDING_H
+#define INPUTRECORDING_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "GameSim.h"
+
+// Input recording layout (little-endian):
+//   ReplayHeader
+//   ReplayRun entries until the end of the file
+// Input rarely changes between ticks, so each run holds one input state and
+// how many ticks it was held for: a two-minute session is a few kilobytes.
+// The header carries the seed and the whole sim config, so a replay needs
+// no textures to rebuild the session.
+struct ReplayHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t tickRate;
+    std::uint32_t seed;
+    ItemKindInfo itemKinds[static_cast<int>(ItemKind::Count)];
+    float playerWidth;
+    float playerHeight;
+    std::uint64_t itemPoolCapacity;
+    std::uint64_t totalTicks; // Filled in when the recording is closed
+    std::uint32_t finalChecksum; // GameSim::checksum() at the end of the session
+    std::uint32_t complete; // 0 if the game exited without closing the recording
+};
+
+struct ReplayRun {
+    std::uint8_t flags;
+    std::uint8_t padding[3];
+    std::uint32_t ticks;
+};
+
+const char REPLAY_MAGIC[4] = { 'F', 'P', 'R', 'P' };
+const std::uint32_t REPLAY_VERSION = 1;
+
+// ReplayRun flags; a run with REPLAY_RESET restarts the game and has no ticks
+const std::uint8_t REPLAY_LEFT = 1 << 0;
+const std::uint8_t REPLAY_RIGHT = 1 << 1;
+const std::uint8_t REPLAY_RESET = 1 << 2;
+
+// Writes every simulated tick's input as the game runs.
+// Runs are written as soon as the input changes, so a crash loses at most
+// the current run; only the end-of-session checksum needs close().
+class InputRecorder {
+public:
+    InputRecorder();
+    ~InputRecorder();
+
+    bool open(const std::string& file, const GameSimConfig& config);
+    bool isOpen() const { return output.is_open(); }
+
+    // Call once per GameSim::step, with the input it is given
+    void recordTick(const InputState& input);
+    // Call whenever the game calls GameSim::reset
+    void recordReset();
+    // Finish the file with the state the session ended in
+    bool close(const GameSim& sim);
+
+private:
+    void writeRun();
+
+    std::ofstream output;
+    ReplayHeader header;
+    ReplayRun run;
+};
+
+// Reads a recording back and feeds it to a simulation
+class InputReplay {
+public:
+    bool open(const std::string& file);
+
+    // Config of the recorded session, seed included
+    GameSimConfig config() const;
+    const ReplayHeader& header() const { return fileHeader; }
+    const std::vector<ReplayRun>& runs() const { return fileRuns; }
+
+    static InputState input(const ReplayRun& run);
+
+private:
+    ReplayHeader fileHeader;
+    std::vector<ReplayRun> fileRuns;
+};
+
+#endif // INPUTRECORDING_H
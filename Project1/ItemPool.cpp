@@ -0,0 +1,57 @@
+#include "ItemPool.h"
+
+ItemPool::ItemPool(std::size_t initialCapacity)
+    : count(0), entities(initialCapacity) {
+    grow(initialCapacity > 0 ? initialCapacity : 1);
+}
+
+void ItemPool::grow(std::size_t newCapacity) {
+    posX.resize(newCapacity);
+    posY.resize(newCapacity);
+    prevPosY.resize(newCapacity);
+    kind.resize(newCapacity);
+    flags.resize(newCapacity);
+    rectIndex.resize(newCapacity);
+    entityId.resize(newCapacity);
+}
+
+EntityHandle ItemPool::spawn(ItemKind itemKind, float x, float y, std::uint16_t rect) {
+    // Only reallocate when the working set outgrows the pool, never per spawn
+    if (count == capacity())
+        grow(capacity() * 2);
+
+    std::size_t index = count++;
+    posX[index] = x;
+    posY[index] = y;
+    prevPosY[index] = y;
+    kind[index] = itemKind;
+    flags[index] = 0;
+    rectIndex[index] = rect;
+
+    EntityHandle handle = entities.acquire(static_cast<std::uint32_t>(index));
+    entityId[index] = handle.id;
+    return handle;
+}
+
+void ItemPool::remove(std::size_t index) {
+    entities.release(entityId[index]);
+
+    // Swap-and-pop: move the last live item into the hole
+    std::size_t last = --count;
+    if (index != last) {
+        posX[index] = posX[last];
+        posY[index] = posY[last];
+        prevPosY[index] = prevPosY[last];
+        kind[index] = kind[last];
+        flags[index] = flags[last];
+        rectIndex[index] = rectIndex[last];
+        entityId[index] = entityId[last];
+        entities.relocate(entityId[index], static_cast<std::uint32_t>(index));
+    }
+}
+
+void ItemPool::clear() {
+    // O(1): live slots and their ids are forgotten, storage is kept for reuse
+    count = 0;
+    entities.reset();
+}
@@ -0,0 +1,61 @@
+#ifndef ITEMPOOL_H
+#define ITEMPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "EntityLifecycle.h"
+
+// Kinds of falling items (fruits and bombs share one pool)
+enum class ItemKind : std::uint8_t {
+    Apple,
+    Bomb,
+    Count
+};
+
+// Per-item flag bits
+const std::uint8_t ITEM_FLAG_COLLECTED = 1 << 0;
+
+// Static data shared by every item of a kind
+struct ItemKindInfo {
+    float width;
+    float height;
+    float collisionInset; // Shrinks the collision box on each side
+    int points;
+};
+
+// Structure-of-arrays pool for falling items.
+// Every attribute lives in its own contiguous array so the update and
+// collision loops stream through memory; removal swaps the last live item
+// into the freed slot, so nothing is shifted and spawning never allocates
+// once the pool has grown to its working size. Each item also gets a stable
+// EntityHandle that survives the swaps.
+class ItemPool {
+public:
+    explicit ItemPool(std::size_t initialCapacity);
+
+    EntityHandle spawn(ItemKind kind, float posX, float posY, std::uint16_t rectIndex = 0);
+    void remove(std::size_t index);
+    void clear();
+
+    const EntityLifecycle& lifecycle() const { return entities; }
+
+    std::size_t size() const { return count; }
+    std::size_t capacity() const { return posX.size(); }
+
+    std::vector<float> posX;
+    std::vector<float> posY;
+    std::vector<float> prevPosY; // Position at the previous tick, for render interpolation
+    std::vector<ItemKind> kind;
+    std::vector<std::uint8_t> flags;
+    std::vector<std::uint16_t> rectIndex;
+    std::vector<std::uint32_t> entityId;
+
+private:
+    void grow(std::size_t newCapacity);
+
+    std::size_t count;
+    EntityLifecycle entities;
+};
+
+#endif // ITEMPOOL_H
@@ -0,0 +1,352 @@
+#include "Leaderboard.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Records read or written per file call while scanning and compacting
+const std::size_t SCAN_BATCH_RECORDS = 8192;
+
+// CRC-32 (IEEE 802.3) lookup table
+struct CrcTable {
+    std::uint32_t entries[256];
+
+    CrcTable() {
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            std::uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+            entries[i] = crc;
+        }
+    }
+};
+
+std::uint32_t recordCrc(const LeaderboardRecord& record) {
+    static const CrcTable table;
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&record) + sizeof(record.crc);
+    std::uint32_t crc = 0xFFFFFFFFu;
+    for (std::size_t i = 0; i < sizeof(record) - sizeof(record.crc); ++i)
+        crc = table.entries[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+LeaderboardRecord makeRecord(int score, std::uint64_t sequence, const ScoreIndex::Name& name) {
+    LeaderboardRecord record;
+    record.score = score;
+    record.sequence = sequence;
+    std::memcpy(record.name, name.data(), sizeof(record.name));
+    record.crc = recordCrc(record);
+    return record;
+}
+
+// Push written data through to the disk, not just to the OS
+bool syncFile(std::FILE* file) {
+    if (std::fflush(file) != 0)
+        return false;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+} // namespace
+
+const std::uint64_t Leaderboard::MIN_COMPACT_TAIL;
+
+Leaderboard::Leaderboard(const std::string& file)
+    : file(file),
+      loaded(false),
+      compactions(0),
+      writing(true),
+      stopping(false),
+      log(nullptr),
+      nextSequence(0),
+      sortedCount(0),
+      needsCompaction(false) {
+    writer = std::thread(&Leaderboard::writerLoop, this);
+}
+
+Leaderboard::~Leaderboard() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueChanged.notify_all();
+    writer.join();
+    if (log)
+        std::fclose(log);
+}
+
+std::future<std::uint64_t> Leaderboard::submit(const std::string& name, int score) {
+    Submission submission;
+    submission.score = score;
+    submission.name.fill('\0');
+    std::memcpy(submission.name.data(), name.data(), std::min(name.size(), submission.name.size()));
+    submission.rank = std::make_shared<std::promise<std::uint64_t>>();
+    std::future<std::uint64_t> rank = submission.rank->get_future();
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queue.push_back(std::move(submission));
+    }
+    queueChanged.notify_all();
+    return rank;
+}
+
+void Leaderboard::writerLoop() {
+    load();
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        loaded = true;
+    }
+
+    for (;;) {
+        std::deque<Submission> batch;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            writing = false;
+            queueChanged.notify_all();
+            queueChanged.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty())
+                return;
+            batch.swap(queue);
+            writing = true;
+        }
+        appendBatch(batch);
+        if (needsCompaction)
+            compact();
+    }
+}
+
+bool Leaderboard::load() {
+    // A compaction interrupted between removing the old log and renaming the
+    // new one leaves only the complete temporary file; otherwise it is partial
+    std::string temp = file + ".tmp";
+    std::FILE* input = std::fopen(file.c_str(), "rb");
+    if (!input) {
+        if (std::rename(temp.c_str(), file.c_str()) == 0)
+            input = std::fopen(file.c_str(), "rb");
+    }
+    else {
+        std::remove(temp.c_str());
+    }
+    if (!input)
+        return openForAppend();
+
+    LeaderboardHeader header;
+    if (std::fread(&header, sizeof(header), 1, input) != 1 || std::memcmp(header.magic, LEADERBOARD_MAGIC, sizeof(LEADERBOARD_MAGIC)) != 0
+        || header.version != LEADERBOARD_VERSION) {
+        // Never append to, or compact over, a file this is not sure it owns
+        std::cerr << "Not a leaderboard log: " << file << std::endl;
+        std::fclose(input);
+        return false;
+    }
+
+    // Stream the log: the sorted part is collected and built in one pass, the tail inserted
+    ScoreIndex scanned;
+    std::vector<int> sortedScores;
+    std::vector<std::uint64_t> sortedSequences;
+    std::vector<ScoreIndex::Name> sortedNames;
+    std::vector<LeaderboardRecord> buffer(SCAN_BATCH_RECORDS);
+    const std::size_t batchBytes = buffer.size() * sizeof(LeaderboardRecord);
+    std::uint64_t records = 0;
+    bool damaged = false;
+    while (!damaged) {
+        std::size_t bytes = std::fread(buffer.data(), 1, batchBytes, input);
+        // Bytes short of a whole record at the end are a torn append
+        damaged = bytes % sizeof(LeaderboardRecord) != 0;
+        for (std::size_t i = 0; i < bytes / sizeof(LeaderboardRecord); ++i) {
+            const LeaderboardRecord& record = buffer[i];
+            bool inSortedPart = records < header.sortedCount;
+            if (record.crc != recordCrc(record) || (inSortedPart && records > 0
+                && !ScoreIndex::ranksAbove(sortedScores.back(), sortedSequences.back(), record.score, record.sequence))) {
+                damaged = true;
+                break;
+            }
+            ScoreIndex::Name name;
+            std::memcpy(name.data(), record.name, name.size());
+            if (inSortedPart) {
+                sortedScores.push_back(record.score);
+                sortedSequences.push_back(record.sequence);
+                sortedNames.push_back(name);
+            }
+            else {
+                if (records == header.sortedCount)
+                    scanned.assignSorted(std::move(sortedScores), std::move(sortedSequences), std::move(sortedNames));
+                scanned.insert(record.score, record.sequence, name);
+            }
+            nextSequence = std::max(nextSequence, record.sequence + 1);
+            ++records;
+        }
+        if (bytes < batchBytes)
+            break;
+    }
+    std::fclose(input);
+    if (records <= header.sortedCount)
+        scanned.assignSorted(std::move(sortedScores), std::move(sortedSequences), std::move(sortedNames));
+    if (damaged || records < header.sortedCount) {
+        std::cerr << "Leaderboard log " << file << " ends in a damaged record after " << records << " runs; the rest is dropped" << std::endl;
+        needsCompaction = true;
+    }
+    sortedCount = std::min(records, header.sortedCount);
+
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        index = std::move(scanned);
+    }
+    return needsCompaction ? compact() : openForAppend();
+}
+
+bool Leaderboard::openForAppend() {
+    log = std::fopen(file.c_str(), "ab");
+    if (!log) {
+        std::cerr << "Failed to open leaderboard log: " << file << std::endl;
+        return false;
+    }
+    std::fseek(log, 0, SEEK_END);
+    if (std::ftell(log) == 0) {
+        LeaderboardHeader header;
+        std::memcpy(header.magic, LEADERBOARD_MAGIC, sizeof(header.magic));
+        header.version = LEADERBOARD_VERSION;
+        header.sortedCount = 0;
+        std::fwrite(&header, sizeof(header), 1, log);
+        syncFile(log);
+    }
+    return true;
+}
+
+void Leaderboard::appendBatch(std::deque<Submission>& batch) {
+    // With no log open (foreign file, or it could not be opened) a rank would
+    // promise a run that is gone on the next start
+    if (!log) {
+        for (const Submission& submission : batch)
+            submission.rank->set_value(LEADERBOARD_NOT_STORED);
+        return;
+    }
+
+    std::vector<LeaderboardRecord> records;
+    records.reserve(batch.size());
+    for (const Submission& submission : batch)
+        records.push_back(makeRecord(submission.score, nextSequence++, submission.name));
+
+    // One write and one sync for every run queued since the last batch
+    if (std::fwrite(records.data(), sizeof(LeaderboardRecord), records.size(), log) != records.size() || !syncFile(log))
+        std::cerr << "Failed to write leaderboard log: " << file << std::endl;
+
+    std::vector<std::uint64_t> ranks(batch.size());
+    std::uint64_t entries;
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        for (std::size_t i = 0; i < batch.size(); ++i)
+            ranks[i] = index.insert(batch[i].score, records[i].sequence, batch[i].name);
+        entries = index.size();
+    }
+    for (std::size_t i = 0; i < batch.size(); ++i)
+        batch[i].rank->set_value(ranks[i]);
+
+    // Doubling keeps the rewrite cost linear in the number of runs ever submitted
+    if (entries - sortedCount >= std::max(MIN_COMPACT_TAIL, sortedCount))
+        needsCompaction = true;
+}
+
+bool Leaderboard::compact() {
+    // Only this thread changes the index, so it can be read here without the lock
+    std::string temp = file + ".tmp";
+    std::FILE* output = std::fopen(temp.c_str(), "wb");
+    if (!output) {
+        std::cerr << "Failed to write leaderboard log: " << temp << std::endl;
+        needsCompaction = false;
+        return false;
+    }
+
+    LeaderboardHeader header;
+    std::memcpy(header.magic, LEADERBOARD_MAGIC, sizeof(header.magic));
+    header.version = LEADERBOARD_VERSION;
+    header.sortedCount = index.size();
+    bool written = std::fwrite(&header, sizeof(header), 1, output) == 1;
+
+    std::vector<ScoreIndex::Node> nodes;
+    std::vector<LeaderboardRecord> records;
+    for (std::uint64_t first = 0; written && first < index.size(); first += nodes.size()) {
+        index.page(first, SCAN_BATCH_RECORDS, nodes);
+        records.clear();
+        for (ScoreIndex::Node node : nodes)
+            records.push_back(makeRecord(index.score(node), index.sequence(node), index.name(node)));
+        written = std::fwrite(records.data(), sizeof(LeaderboardRecord), records.size(), output) == records.size();
+    }
+    written = written && syncFile(output);
+    std::fclose(output);
+    if (!written) {
+        std::cerr << "Failed to write leaderboard log: " << temp << std::endl;
+        std::remove(temp.c_str());
+        needsCompaction = false;
+        return log != nullptr;
+    }
+
+    // rename() does not replace an existing file on Windows; load() recovers if this stops in between
+    if (log) {
+        std::fclose(log);
+        log = nullptr;
+    }
+    std::remove(file.c_str());
+    if (std::rename(temp.c_str(), file.c_str()) != 0) {
+        std::cerr << "Failed to replace leaderboard log: " << file << std::endl;
+        return false;
+    }
+
+    sortedCount = header.sortedCount;
+    needsCompaction = false;
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        ++compactions;
+    }
+    return openForAppend();
+}
+
+bool Leaderboard::isLoaded() const {
+    std::lock_guard<std::mutex> lock(indexMutex);
+    return loaded;
+}
+
+std::uint64_t Leaderboard::size() const {
+    std::lock_guard<std::mutex> lock(indexMutex);
+    return index.size();
+}
+
+std::uint64_t Leaderboard::rankOf(int score) const {
+    // A new run loses ties to every run already on the board
+    std::lock_guard<std::mutex> lock(indexMutex);
+    return index.rankOf(score, UINT64_MAX);
+}
+
+std::vector<LeaderboardEntry> Leaderboard::page(std::uint64_t first, std::size_t count) const {
+    std::vector<ScoreIndex::Node> nodes;
+    std::vector<LeaderboardEntry> entries;
+    std::lock_guard<std::mutex> lock(indexMutex);
+    index.page(first, count, nodes);
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        const ScoreIndex::Name& name = index.name(nodes[i]);
+        LeaderboardEntry entry;
+        entry.rank = first + i;
+        entry.score = index.score(nodes[i]);
+        entry.name.assign(name.begin(), std::find(name.begin(), name.end(), '\0'));
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+std::uint64_t Leaderboard::compactionCount() const {
+    std::lock_guard<std::mutex> lock(indexMutex);
+    return compactions;
+}
+
+void Leaderboard::waitUntilIdle() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    queueChanged.wait(lock, [this] { return !writing && queue.empty(); });
+}
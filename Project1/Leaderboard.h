@@ -0,0 +1,120 @@
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ScoreIndex.h"
+
+// Leaderboard log layout (little-endian):
+//   LeaderboardHeader
+//   LeaderboardRecord entries until the end of the file
+// The first sortedCount records are in rank order (written by compaction);
+// the rest are runs appended since, in the order they finished. A record
+// whose CRC does not match ends the log: it is what a crash mid-append
+// leaves, and the next compaction drops it.
+struct LeaderboardHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t sortedCount;
+};
+
+struct LeaderboardRecord {
+    std::uint32_t crc; // CRC-32 of the rest of the record
+    std::int32_t score;
+    std::uint64_t sequence; // Order the run finished in; earlier runs win ties
+    char name[LEADERBOARD_NAME_LENGTH];
+};
+
+const char LEADERBOARD_MAGIC[4] = { 'F', 'P', 'L', 'B' };
+const std::uint32_t LEADERBOARD_VERSION = 1;
+
+// Rank given to a run that could not be written, e.g. because the log file
+// belongs to something else; such runs are not ranked either
+const std::uint64_t LEADERBOARD_NOT_STORED = ~static_cast<std::uint64_t>(0);
+
+// One ranked row for display
+struct LeaderboardEntry {
+    std::uint64_t rank; // 0-based
+    int score;
+    std::string name;
+};
+
+// Every finished run, persisted and ranked.
+// All file I/O happens on a background thread: submit() only queues the
+// run, so the game thread never waits for the disk when a run ends. The
+// thread first rebuilds the index with a streaming scan of the log, then
+// appends queued runs (one flush per batch) and rewrites the log in rank
+// order once the unsorted tail grows as long as the sorted part.
+class Leaderboard {
+public:
+    // Compaction waits for at least this many appended runs
+    static const std::uint64_t MIN_COMPACT_TAIL = 4096;
+
+    explicit Leaderboard(const std::string& file);
+    // Writes every run still queued before returning
+    ~Leaderboard();
+    Leaderboard(const Leaderboard&) = delete;
+    Leaderboard& operator=(const Leaderboard&) = delete;
+
+    // Queue a finished run; the future gets its 0-based rank once it is on disk,
+    // or LEADERBOARD_NOT_STORED when there is no usable log to write it to
+    std::future<std::uint64_t> submit(const std::string& name, int score);
+
+    // Queries are answered from the index; before the startup scan finishes it is empty
+    bool isLoaded() const;
+    std::uint64_t size() const;
+    // Rank a new run with this score would get
+    std::uint64_t rankOf(int score) const;
+    // Up to count rows starting at a 0-based rank
+    std::vector<LeaderboardEntry> page(std::uint64_t first, std::size_t count) const;
+
+    // Bookkeeping for tests and benchmarks
+    std::uint64_t compactionCount() const;
+    void waitUntilIdle();
+
+private:
+    struct Submission {
+        std::int32_t score;
+        ScoreIndex::Name name;
+        std::shared_ptr<std::promise<std::uint64_t>> rank;
+    };
+
+    void writerLoop();
+    bool load();
+    bool openForAppend();
+    void appendBatch(std::deque<Submission>& batch);
+    bool compact();
+
+    std::string file;
+
+    // Guards the index; only the writer thread changes it
+    mutable std::mutex indexMutex;
+    ScoreIndex index;
+    bool loaded;
+    std::uint64_t compactions;
+
+    // Guards the submission queue
+    std::mutex queueMutex;
+    std::condition_variable queueChanged;
+    std::deque<Submission> queue;
+    bool writing;
+    bool stopping;
+
+    // Writer thread only
+    std::FILE* log;
+    std::uint64_t nextSequence;
+    std::uint64_t sortedCount;
+    bool needsCompaction;
+
+    std::thread writer;
+};
+
+#endif // LEADERBOARD_H
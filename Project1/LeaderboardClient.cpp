@@ -0,0 +1,123 @@
+#include "LeaderboardClient.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+namespace {
+
+const sf::Time CONNECT_TIMEOUT = sf::seconds(2.0f);
+const sf::Time REPLY_TIMEOUT = sf::seconds(5.0f);
+const sf::Time FIRST_RETRY_DELAY = sf::milliseconds(500);
+const sf::Time MAX_RETRY_DELAY = sf::seconds(30.0f);
+
+} // namespace
+
+LeaderboardClient::LeaderboardClient(const sf::IpAddress& server, unsigned short port)
+    : server(server),
+      port(port),
+      connected(false),
+      nextRequestId(0),
+      boardSize(0),
+      stopping(false) {
+    // 40 random high bits keep ids from different kiosks (and restarts) apart; the low 24 count runs
+    std::random_device seed;
+    nextSubmissionId = ((static_cast<std::uint64_t>(seed()) << 32) | seed()) << 24;
+    sender = std::thread(&LeaderboardClient::senderLoop, this);
+}
+
+LeaderboardClient::~LeaderboardClient() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    sender.join();
+}
+
+std::future<std::uint64_t> LeaderboardClient::submit(const std::string& name, int score) {
+    Submission submission;
+    submission.name = name;
+    submission.score = score;
+    submission.rank = std::make_shared<std::promise<std::uint64_t>>();
+    std::future<std::uint64_t> rank = submission.rank->get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        submission.id = nextSubmissionId++;
+        queue.push_back(std::move(submission));
+    }
+    changed.notify_all();
+    return rank;
+}
+
+void LeaderboardClient::pause(sf::Time time) {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait_for(lock, std::chrono::microseconds(time.asMicroseconds()), [this] { return stopping; });
+}
+
+void LeaderboardClient::senderLoop() {
+    sf::Time retryDelay = FIRST_RETRY_DELAY;
+    for (;;) {
+        Submission submission;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping)
+                return;
+            submission = queue.front();
+        }
+
+        std::uint64_t rank;
+        if (!send(submission, rank)) {
+            // Reconnect from scratch next time; the run stays at the front of the queue
+            socket.disconnect();
+            connected = false;
+            pause(retryDelay);
+            retryDelay = std::min(retryDelay * 2.0f, MAX_RETRY_DELAY);
+            continue;
+        }
+        retryDelay = FIRST_RETRY_DELAY;
+        submission.rank->set_value(rank);
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.pop_front();
+    }
+}
+
+bool LeaderboardClient::send(const Submission& submission, std::uint64_t& rank) {
+    if (!connected) {
+        if (socket.connect(server, port, CONNECT_TIMEOUT) != sf::Socket::Done)
+            return false;
+        connected = true;
+    }
+
+    sf::Uint32 requestId = nextRequestId++;
+    sf::Packet request;
+    request << static_cast<sf::Uint8>(LeaderboardMessage::Submit) << requestId
+            << static_cast<sf::Uint64>(submission.id) << submission.name << static_cast<sf::Int32>(submission.score);
+    if (socket.send(request) != sf::Socket::Done)
+        return false;
+
+    // Replies to requests abandoned by an earlier timeout are skipped
+    sf::SocketSelector selector;
+    selector.add(socket);
+    sf::Clock clock;
+    for (;;) {
+        sf::Time left = REPLY_TIMEOUT - clock.getElapsedTime();
+        if (left <= sf::Time::Zero || !selector.wait(left))
+            return false;
+        sf::Packet reply;
+        if (socket.receive(reply) != sf::Socket::Done)
+            return false;
+        sf::Uint8 type;
+        sf::Uint32 replyId;
+        sf::Uint64 entries;
+        sf::Uint64 replyRank;
+        if (!(reply >> type >> replyId >> entries >> replyRank))
+            return false;
+        if (replyId != requestId)
+            continue;
+        boardSize = entries;
+        rank = replyRank;
+        return true;
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef LEADERBOARDCLIENT_H
+#define LEADERBOARDCLIENT_H
+
+#include <SFML/Network.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "LeaderboardProtocol.h"
+
+// Sends finished runs to a LeaderboardServer from a background thread.
+// submit() only queues the run, so the game never waits on the network.
+// Runs are sent one at a time, oldest first; a run stays queued until the
+// server confirms it, and a dropped connection is retried with exponential
+// backoff. Resends reuse the submission id, so the server keeps one copy.
+class LeaderboardClient {
+public:
+    LeaderboardClient(const sf::IpAddress& server, unsigned short port);
+    // Runs not confirmed by then are dropped
+    ~LeaderboardClient();
+    LeaderboardClient(const LeaderboardClient&) = delete;
+    LeaderboardClient& operator=(const LeaderboardClient&) = delete;
+
+    // The future gets the run's 0-based rank once the server has stored it
+    std::future<std::uint64_t> submit(const std::string& name, int score);
+
+    // Entries on the board at the last reply
+    std::uint64_t size() const { return boardSize; }
+
+private:
+    struct Submission {
+        std::uint64_t id;
+        std::string name;
+        int score;
+        std::shared_ptr<std::promise<std::uint64_t>> rank;
+    };
+
+    void senderLoop();
+    bool send(const Submission& submission, std::uint64_t& rank);
+    // Sleep, but wake straight away if the client is being destroyed
+    void pause(sf::Time time);
+
+    sf::IpAddress server;
+    unsigned short port;
+    sf::TcpSocket socket;
+    bool connected;
+    sf::Uint32 nextRequestId;
+    std::uint64_t nextSubmissionId;
+    std::atomic<std::uint64_t> boardSize;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<Submission> queue;
+    bool stopping;
+
+    std::thread sender;
+};
+
+#endif // LEADERBOARDCLIENT_H
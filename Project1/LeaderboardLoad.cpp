@@ -0,0 +1,148 @@
+#include "LeaderboardLoad.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "GameSim.h"
+#include "LeaderboardProtocol.h"
+
+namespace {
+
+// Client connections per load thread; a selector on Windows watches at most 64 sockets
+const int CLIENTS_PER_THREAD = 60;
+// A round whose replies stop arriving for this long ends the thread
+const float REPLY_TIMEOUT = 5.0f;
+
+typedef std::chrono::steady_clock LoadClock;
+
+struct LoadResult {
+    std::vector<float> latencies; // Microseconds per request
+    std::uint64_t errors;
+};
+
+// Request mix: 1 in 5 submits a run, 1 in 5 fetches the top 10, the rest ask for a rank
+sf::Packet makeRequest(SimRandom& random, sf::Uint32 requestId, std::uint64_t submissionId) {
+    sf::Packet packet;
+    int kind = random.range(5);
+    int score = random.range(2000) - 200;
+    if (kind == 0) {
+        packet << static_cast<sf::Uint8>(LeaderboardMessage::Submit) << requestId << static_cast<sf::Uint64>(submissionId)
+               << std::string("LoadTest") << static_cast<sf::Int32>(score);
+    }
+    else if (kind == 1) {
+        packet << static_cast<sf::Uint8>(LeaderboardMessage::Top) << requestId << static_cast<sf::Uint64>(0) << static_cast<sf::Uint16>(10);
+    }
+    else {
+        packet << static_cast<sf::Uint8>(LeaderboardMessage::Rank) << requestId << static_cast<sf::Int32>(score);
+    }
+    return packet;
+}
+
+void runLoadThread(const sf::IpAddress& server, unsigned short port, int clients, int threadIndex,
+                   LoadClock::time_point deadline, LoadResult& result) {
+    result.errors = 0;
+    std::vector<std::unique_ptr<sf::TcpSocket>> sockets;
+    for (int i = 0; i < clients; ++i) {
+        std::unique_ptr<sf::TcpSocket> socket(new sf::TcpSocket());
+        if (socket->connect(server, port, sf::seconds(5.0f)) == sf::Socket::Done)
+            sockets.push_back(std::move(socket));
+        else
+            ++result.errors;
+    }
+
+    // Every client sends, then replies are collected in the order they arrive:
+    // each is timestamped as soon as its socket becomes readable, so a slow
+    // reply does not add to the latency of the ones behind it
+    sf::SocketSelector selector;
+    for (const std::unique_ptr<sf::TcpSocket>& socket : sockets)
+        selector.add(*socket);
+    SimRandom random(static_cast<std::uint32_t>(threadIndex + 1));
+    std::uint64_t submissionId = static_cast<std::uint64_t>(threadIndex) << 48 | static_cast<std::uint64_t>(random.next()) << 24;
+    std::vector<LoadClock::time_point> sent(sockets.size());
+    std::vector<bool> alive(sockets.size(), true), waiting(sockets.size());
+    std::size_t aliveCount = sockets.size();
+    sf::Uint32 requestId = 0;
+    while (LoadClock::now() < deadline && aliveCount > 0) {
+        std::size_t pending = 0;
+        for (std::size_t i = 0; i < sockets.size(); ++i) {
+            waiting[i] = false;
+            if (!alive[i])
+                continue;
+            sf::Packet request = makeRequest(random, requestId, submissionId++);
+            sent[i] = LoadClock::now();
+            if (sockets[i]->send(request) != sf::Socket::Done) {
+                ++result.errors;
+                continue;
+            }
+            waiting[i] = true;
+            ++pending;
+        }
+        while (pending > 0) {
+            if (!selector.wait(sf::seconds(REPLY_TIMEOUT))) {
+                result.errors += pending;
+                return;
+            }
+            LoadClock::time_point readable = LoadClock::now();
+            for (std::size_t i = 0; i < sockets.size(); ++i) {
+                if (!waiting[i] || !selector.isReady(*sockets[i]))
+                    continue;
+                waiting[i] = false;
+                --pending;
+                sf::Packet reply;
+                if (sockets[i]->receive(reply) != sf::Socket::Done) {
+                    // Closed by the server: stop using this client
+                    ++result.errors;
+                    selector.remove(*sockets[i]);
+                    alive[i] = false;
+                    --aliveCount;
+                    continue;
+                }
+                std::chrono::duration<float, std::micro> latency = readable - sent[i];
+                result.latencies.push_back(latency.count());
+            }
+        }
+        ++requestId;
+    }
+}
+
+float percentile(const std::vector<float>& sorted, float fraction) {
+    if (sorted.empty())
+        return 0.0f;
+    return sorted[static_cast<std::size_t>(fraction * (sorted.size() - 1) + 0.5f)];
+}
+
+} // namespace
+
+int runLeaderboardLoad(const sf::IpAddress& server, unsigned short port, int clients, float seconds) {
+    int threadCount = std::max(1, (clients + CLIENTS_PER_THREAD - 1) / CLIENTS_PER_THREAD);
+    std::vector<LoadResult> results(threadCount);
+    std::vector<std::thread> threads;
+    LoadClock::time_point start = LoadClock::now();
+    LoadClock::time_point deadline = start + std::chrono::microseconds(static_cast<long long>(seconds * 1e6f));
+    for (int i = 0; i < threadCount; ++i) {
+        int threadClients = clients / threadCount + (i < clients % threadCount ? 1 : 0);
+        threads.emplace_back(runLoadThread, server, port, threadClients, i, deadline, std::ref(results[i]));
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    std::chrono::duration<double> elapsed = LoadClock::now() - start;
+
+    std::vector<float> latencies;
+    std::uint64_t errors = 0;
+    for (const LoadResult& result : results) {
+        latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+        errors += result.errors;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << clients << " clients, " << latencies.size() << " requests in " << elapsed.count() << " s: "
+              << latencies.size() / elapsed.count() << " requests/s" << std::endl;
+    std::cout << "Latency us: p50 " << percentile(latencies, 0.5f) << ", p99 " << percentile(latencies, 0.99f)
+              << ", max " << percentile(latencies, 1.0f) << std::endl;
+    if (errors > 0)
+        std::cout << errors << " connections or requests failed" << std::endl;
+    return errors == 0 && !latencies.empty() ? 0 : 1;
+}
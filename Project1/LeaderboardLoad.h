@@ -0,0 +1,14 @@
+#ifndef LEADERBOARDLOAD_H
+#define LEADERBOARDLOAD_H
+
+#include <SFML/Network.hpp>
+
+// Load generator for a running LeaderboardServer.
+// Opens one connection per simulated client, spread over threads of up to
+// 60 clients, and keeps one request in flight per client for the given time:
+// a mix of submissions, rank queries and top-10 pages. Replies are timed
+// when their socket becomes readable. Prints requests per second and latency
+// percentiles; returns the process exit code.
+int runLeaderboardLoad(const sf::IpAddress& server, unsigned short port, int clients, float seconds);
+
+#endif // LEADERBOARDLOAD_H
@@ -0,0 +1,29 @@
+#ifndef LEADERBOARDPROTOCOL_H
+#define LEADERBOARDPROTOCOL_H
+
+#include <SFML/Network.hpp>
+
+// Messages between the game and the leaderboard server, one sf::Packet each.
+// Every request starts with its type and a request id the reply echoes:
+//   Submit: submission id (Uint64), name (string), score (Int32)
+//   Rank:   score (Int32)
+//   Top:    first rank (Uint64), count (Uint16)
+// Every reply starts with the same type and request id, then the number of
+// entries on the board (Uint64):
+//   Submit, Rank: 0-based rank (Uint64); a submission the server could not
+//                 store gets LEADERBOARD_NOT_STORED
+//   Top:          row count (Uint16), then per row rank (Uint64), score (Int32), name (string)
+// A client that resends a submission after losing its connection reuses the
+// submission id, so the server records the run only once.
+enum class LeaderboardMessage : sf::Uint8 {
+    Submit,
+    Rank,
+    Top
+};
+
+const unsigned short LEADERBOARD_PORT = 53000;
+
+// Rows returned by one Top request at most
+const sf::Uint16 LEADERBOARD_MAX_PAGE = 100;
+
+#endif // LEADERBOARDPROTOCOL_H
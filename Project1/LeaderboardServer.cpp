@@ -0,0 +1,288 @@
+#include "LeaderboardServer.h"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+// How long a worker waits for socket activity before checking for finished submissions
+const sf::Time WORKER_POLL_INTERVAL = sf::milliseconds(2);
+// How long the accept loop waits before checking whether it should stop
+const sf::Time ACCEPT_POLL_INTERVAL = sf::milliseconds(100);
+// How often the server prints its request rate
+const sf::Time STATS_INTERVAL = sf::seconds(10.0f);
+
+} // namespace
+
+// One thread, one selector and up to CLIENTS_PER_SELECTOR clients
+class LeaderboardServer::Worker {
+public:
+    explicit Worker(LeaderboardServer& server)
+        : server(server),
+          clientCount(0),
+          stopping(false) {
+        thread = std::thread(&Worker::loop, this);
+    }
+
+    ~Worker() {
+        stopping = true;
+        thread.join();
+    }
+
+    // Called from the accept loop; the worker picks the socket up on its next pass
+    void add(std::unique_ptr<sf::TcpSocket> socket) {
+        ++clientCount;
+        std::lock_guard<std::mutex> lock(inboxMutex);
+        inbox.push_back(std::move(socket));
+    }
+
+    std::size_t getClientCount() const { return clientCount; }
+
+private:
+    struct Client {
+        std::unique_ptr<sf::TcpSocket> socket;
+        std::deque<sf::Packet> outbox; // A packet that went out partially stays at the front
+        bool closed;
+    };
+
+    struct PendingReply {
+        Client* client;
+        sf::Uint32 requestId;
+        std::shared_future<std::uint64_t> rank;
+    };
+
+    void loop() {
+        while (!stopping) {
+            takeNewClients();
+            if (selector.wait(WORKER_POLL_INTERVAL)) {
+                for (std::unique_ptr<Client>& client : clients) {
+                    if (selector.isReady(*client->socket))
+                        receive(*client);
+                }
+            }
+            sendFinishedSubmissions();
+            for (std::unique_ptr<Client>& client : clients)
+                flush(*client);
+            removeClosedClients();
+        }
+    }
+
+    void takeNewClients() {
+        std::lock_guard<std::mutex> lock(inboxMutex);
+        for (std::unique_ptr<sf::TcpSocket>& socket : inbox) {
+            socket->setBlocking(false);
+            selector.add(*socket);
+            clients.push_back(std::unique_ptr<Client>(new Client{ std::move(socket), std::deque<sf::Packet>(), false }));
+        }
+        inbox.clear();
+    }
+
+    void receive(Client& client) {
+        // Non-blocking: SFML keeps a partly received packet until the rest arrives
+        for (;;) {
+            sf::Packet packet;
+            sf::Socket::Status status = client.socket->receive(packet);
+            if (status == sf::Socket::Done) {
+                handle(client, packet);
+            }
+            else {
+                if (status == sf::Socket::Disconnected || status == sf::Socket::Error)
+                    client.closed = true;
+                return;
+            }
+        }
+    }
+
+    void handle(Client& client, sf::Packet& request) {
+        ++server.requests;
+        sf::Uint8 type;
+        sf::Uint32 requestId;
+        if (!(request >> type >> requestId)) {
+            client.closed = true;
+            return;
+        }
+
+        sf::Packet reply;
+        reply << type << requestId;
+        if (type == static_cast<sf::Uint8>(LeaderboardMessage::Submit)) {
+            sf::Uint64 submissionId;
+            std::string name;
+            sf::Int32 score;
+            if (!(request >> submissionId >> name >> score)) {
+                client.closed = true;
+                return;
+            }
+            // Answered once the writer thread has stored it
+            pending.push_back({ &client, requestId, server.submit(submissionId, name, score) });
+            return;
+        }
+        else if (type == static_cast<sf::Uint8>(LeaderboardMessage::Rank)) {
+            sf::Int32 score;
+            if (!(request >> score)) {
+                client.closed = true;
+                return;
+            }
+            reply << static_cast<sf::Uint64>(server.leaderboard.size()) << static_cast<sf::Uint64>(server.leaderboard.rankOf(score));
+        }
+        else if (type == static_cast<sf::Uint8>(LeaderboardMessage::Top)) {
+            sf::Uint64 first;
+            sf::Uint16 count;
+            if (!(request >> first >> count)) {
+                client.closed = true;
+                return;
+            }
+            std::vector<LeaderboardEntry> rows = server.leaderboard.page(first, std::min(count, LEADERBOARD_MAX_PAGE));
+            reply << static_cast<sf::Uint64>(server.leaderboard.size()) << static_cast<sf::Uint16>(rows.size());
+            for (const LeaderboardEntry& row : rows)
+                reply << static_cast<sf::Uint64>(row.rank) << static_cast<sf::Int32>(row.score) << row.name;
+        }
+        else {
+            client.closed = true;
+            return;
+        }
+        client.outbox.push_back(reply);
+    }
+
+    void sendFinishedSubmissions() {
+        for (std::size_t i = 0; i < pending.size();) {
+            PendingReply& reply = pending[i];
+            if (reply.rank.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                ++i;
+                continue;
+            }
+            sf::Packet packet;
+            packet << static_cast<sf::Uint8>(LeaderboardMessage::Submit) << reply.requestId
+                   << static_cast<sf::Uint64>(server.leaderboard.size()) << static_cast<sf::Uint64>(reply.rank.get());
+            reply.client->outbox.push_back(packet);
+            pending[i] = pending.back();
+            pending.pop_back();
+        }
+    }
+
+    void flush(Client& client) {
+        while (!client.closed && !client.outbox.empty()) {
+            sf::Socket::Status status = client.socket->send(client.outbox.front());
+            if (status == sf::Socket::Done)
+                client.outbox.pop_front();
+            else if (status == sf::Socket::Partial || status == sf::Socket::NotReady)
+                return; // The same packet is sent again next pass, as SFML requires
+            else
+                client.closed = true;
+        }
+    }
+
+    void removeClosedClients() {
+        for (std::size_t i = 0; i < clients.size();) {
+            Client* client = clients[i].get();
+            if (!client->closed) {
+                ++i;
+                continue;
+            }
+            // The runs are still stored; only the replies are dropped
+            pending.erase(std::remove_if(pending.begin(), pending.end(),
+                [client](const PendingReply& reply) { return reply.client == client; }), pending.end());
+            selector.remove(*client->socket);
+            clients[i] = std::move(clients.back());
+            clients.pop_back();
+            --clientCount;
+        }
+    }
+
+    LeaderboardServer& server;
+    sf::SocketSelector selector;
+    std::vector<std::unique_ptr<Client>> clients;
+    std::vector<PendingReply> pending;
+    std::atomic<std::size_t> clientCount;
+    std::atomic<bool> stopping;
+
+    std::mutex inboxMutex;
+    std::vector<std::unique_ptr<sf::TcpSocket>> inbox;
+
+    std::thread thread;
+};
+
+const std::size_t LeaderboardServer::CLIENTS_PER_SELECTOR;
+const std::size_t LeaderboardServer::RECENT_SUBMISSIONS;
+
+LeaderboardServer::LeaderboardServer(Leaderboard& leaderboard)
+    : leaderboard(leaderboard),
+      stopping(false),
+      connections(0),
+      requests(0),
+      submissions(0),
+      coalesced(0) {
+}
+
+LeaderboardServer::~LeaderboardServer() {
+    workers.clear();
+}
+
+bool LeaderboardServer::listen(unsigned short port) {
+    if (listener.listen(port) != sf::Socket::Done) {
+        std::cerr << "Failed to listen on port " << port << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void LeaderboardServer::run() {
+    sf::SocketSelector acceptSelector;
+    acceptSelector.add(listener);
+    sf::Clock statsClock;
+    std::uint64_t lastRequests = 0;
+    while (!stopping) {
+        if (statsClock.getElapsedTime() >= STATS_INTERVAL) {
+            std::uint64_t total = requests;
+            std::cout << "Leaderboard: " << leaderboard.size() << " runs, " << (total - lastRequests) / statsClock.restart().asSeconds()
+                      << " requests/s, " << coalesced << " resent submissions coalesced" << std::endl;
+            lastRequests = total;
+        }
+        if (!acceptSelector.wait(ACCEPT_POLL_INTERVAL))
+            continue;
+        std::unique_ptr<sf::TcpSocket> socket(new sf::TcpSocket());
+        if (listener.accept(*socket) != sf::Socket::Done)
+            continue;
+        ++connections;
+
+        // Fill the least busy worker; start another when they are all full
+        Worker* target = nullptr;
+        for (std::unique_ptr<Worker>& worker : workers) {
+            if (worker->getClientCount() < CLIENTS_PER_SELECTOR && (!target || worker->getClientCount() < target->getClientCount()))
+                target = worker.get();
+        }
+        if (!target) {
+            workers.push_back(std::unique_ptr<Worker>(new Worker(*this)));
+            target = workers.back().get();
+        }
+        target->add(std::move(socket));
+    }
+    workers.clear();
+    listener.close();
+}
+
+std::shared_future<std::uint64_t> LeaderboardServer::submit(std::uint64_t submissionId, const std::string& name, int score) {
+    std::lock_guard<std::mutex> lock(submissionsMutex);
+    auto found = recentSubmissions.find(submissionId);
+    if (found != recentSubmissions.end()) {
+        ++coalesced;
+        return found->second;
+    }
+
+    ++submissions;
+    std::shared_future<std::uint64_t> rank = leaderboard.submit(name, score).share();
+    recentSubmissions[submissionId] = rank;
+    submissionOrder.push_back(submissionId);
+    if (submissionOrder.size() > RECENT_SUBMISSIONS) {
+        recentSubmissions.erase(submissionOrder.front());
+        submissionOrder.pop_front();
+    }
+    return rank;
+}
+
+LeaderboardServer::Stats LeaderboardServer::getStats() const {
+    Stats stats;
+    stats.connections = connections;
+    stats.requests = requests;
+    stats.submissions = submissions;
+    stats.coalesced = coalesced;
+    return stats;
+}
@@ -0,0 +1,72 @@
+#ifndef LEADERBOARDSERVER_H
+#define LEADERBOARDSERVER_H
+
+#include <SFML/Network.hpp>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Leaderboard.h"
+#include "LeaderboardProtocol.h"
+
+// Shared leaderboard for kiosks on the local network.
+// The accept loop hands each client to a worker thread that watches up to
+// CLIENTS_PER_SELECTOR sockets with its own sf::SocketSelector, so the
+// number of clients is not limited by one select() call. Workers never
+// block on the disk: submissions go to the Leaderboard's writer thread,
+// which coalesces everything queued while it was syncing into one write,
+// and the reply is sent once its future is ready. Rank and Top queries are
+// answered straight from the in-memory index.
+class LeaderboardServer {
+public:
+    // Windows select() watches at most 64 sockets unless FD_SETSIZE is raised
+    static const std::size_t CLIENTS_PER_SELECTOR = 63;
+    // Submission ids remembered for coalescing resent runs
+    static const std::size_t RECENT_SUBMISSIONS = 65536;
+
+    struct Stats {
+        std::uint64_t connections;
+        std::uint64_t requests;
+        std::uint64_t submissions;
+        std::uint64_t coalesced; // Resent submissions answered from an earlier one
+    };
+
+    explicit LeaderboardServer(Leaderboard& leaderboard);
+    ~LeaderboardServer();
+    LeaderboardServer(const LeaderboardServer&) = delete;
+    LeaderboardServer& operator=(const LeaderboardServer&) = delete;
+
+    bool listen(unsigned short port);
+    // Accepts clients until stop() is called from another thread
+    void run();
+    void stop() { stopping = true; }
+
+    Stats getStats() const;
+
+private:
+    class Worker;
+
+    // Queue a run, or return the earlier result if this submission id was already seen
+    std::shared_future<std::uint64_t> submit(std::uint64_t submissionId, const std::string& name, int score);
+
+    Leaderboard& leaderboard;
+    sf::TcpListener listener;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<bool> stopping;
+
+    std::mutex submissionsMutex;
+    std::unordered_map<std::uint64_t, std::shared_future<std::uint64_t>> recentSubmissions;
+    std::deque<std::uint64_t> submissionOrder;
+
+    std::atomic<std::uint64_t> connections;
+    std::atomic<std::uint64_t> requests;
+    std::atomic<std::uint64_t> submissions;
+    std::atomic<std::uint64_t> coalesced;
+};
+
+#endif // LEADERBOARDSERVER_H
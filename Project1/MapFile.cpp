@@ -0,0 +1,115 @@
+#include "MapFile.h"
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+bool convertTextMap(const std::string& textFile, const std::string& binaryFile, int tileSize) {
+    if (tileSize <= 0) {
+        std::cerr << "Invalid tile size: " << tileSize << std::endl;
+        return false;
+    }
+    std::ifstream input(textFile);
+    if (!input.is_open()) {
+        std::cerr << "Failed to open map file: " << textFile << std::endl;
+        return false;
+    }
+    std::ofstream output(binaryFile, std::ios::binary | std::ios::trunc);
+    if (!output.is_open()) {
+        std::cerr << "Failed to write map file: " << binaryFile << std::endl;
+        return false;
+    }
+
+    MapFileHeader header;
+    std::memcpy(header.magic, MAP_FILE_MAGIC, sizeof(header.magic));
+    header.version = MAP_FILE_VERSION;
+    header.width = 0;
+    header.height = 0;
+    header.layers = 1;
+    header.tileSize = static_cast<std::uint32_t>(tileSize);
+    header.dataOffset = sizeof(MapFileHeader);
+
+    // Placeholder header; the dimensions are only known once every row has been read
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::string line;
+    std::vector<std::uint16_t> row;
+    while (std::getline(input, line)) {
+        row.clear();
+        const char* cursor = line.c_str();
+        char* end = nullptr;
+        for (long value = std::strtol(cursor, &end, 10); end != cursor; value = std::strtol(cursor, &end, 10)) {
+            if (value < 0 || value > UINT16_MAX) {
+                std::cerr << "Map row " << header.height << " has tile " << value << ", outside 0-" << UINT16_MAX << std::endl;
+                return false;
+            }
+            row.push_back(static_cast<std::uint16_t>(value));
+            cursor = end;
+        }
+        if (row.empty())
+            continue;
+
+        if (header.height == 0) {
+            header.width = static_cast<std::uint32_t>(row.size());
+        }
+        else if (row.size() != header.width) {
+            std::cerr << "Map row " << header.height << " has " << row.size() << " tiles, expected " << header.width << std::endl;
+            return false;
+        }
+        output.write(reinterpret_cast<const char*>(row.data()), row.size() * sizeof(std::uint16_t));
+        ++header.height;
+    }
+
+    output.seekp(0);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    return static_cast<bool>(output);
+}
+
+bool MapFileReader::open(const std::string& path) {
+    if (!file.open(path)) {
+        std::cerr << "Failed to open map file: " << path << std::endl;
+        return false;
+    }
+
+    if (file.size() < sizeof(MapFileHeader) || std::memcmp(header().magic, MAP_FILE_MAGIC, sizeof(MAP_FILE_MAGIC)) != 0
+        || header().version != MAP_FILE_VERSION || header().dataOffset % sizeof(std::uint16_t) != 0) {
+        std::cerr << "Not a binary map file: " << path << std::endl;
+        file.close();
+        return false;
+    }
+    // TileMap keeps the dimensions as ints
+    const MapFileHeader& h = header();
+    const std::uint32_t maxDimension = static_cast<std::uint32_t>(INT_MAX);
+    if (h.width > maxDimension || h.height > maxDimension || h.layers > maxDimension) {
+        std::cerr << "Invalid dimensions " << h.width << "x" << h.height << "x" << h.layers << " in map file: " << path << std::endl;
+        file.close();
+        return false;
+    }
+    // Each factor is checked against the tiles the file holds, so the product cannot wrap
+    if (h.dataOffset > file.size()) {
+        std::cerr << "Truncated map file: " << path << std::endl;
+        file.close();
+        return false;
+    }
+    std::uint64_t available = (file.size() - h.dataOffset) / sizeof(std::uint16_t);
+    std::uint64_t area = static_cast<std::uint64_t>(h.width) * h.height; // Below 2^62
+    if (h.layers != 0 && area > available / h.layers) {
+        std::cerr << "Truncated map file: " << path << std::endl;
+        file.close();
+        return false;
+    }
+    // TileMap divides by the tile size and keeps it as an int
+    if (header().tileSize == 0 || header().tileSize > static_cast<std::uint32_t>(INT_MAX)) {
+        std::cerr << "Invalid tile size " << header().tileSize << " in map file: " << path << std::endl;
+        file.close();
+        return false;
+    }
+    return true;
+}
+
+std::size_t MapFileReader::tileCount() const {
+    const MapFileHeader& h = header();
+    return static_cast<std::size_t>(h.width) * h.height * h.layers;
+}
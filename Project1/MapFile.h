@@ -0,0 +1,43 @@
+#ifndef MAPFILE_H
+#define MAPFILE_H
+
+#include <cstdint>
+#include <string>
+#include "MappedFile.h"
+
+// Binary tile map layout (little-endian):
+//   MapFileHeader
+//   layers * height * width uint16 tile indices, layer by layer, row-major
+// The tile block starts at dataOffset so it can be used straight from a
+// memory mapping without any per-tile parsing.
+struct MapFileHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t layers;
+    std::uint32_t tileSize;
+    std::uint64_t dataOffset;
+};
+
+const char MAP_FILE_MAGIC[4] = { 'F', 'P', 'M', 'P' };
+const std::uint32_t MAP_FILE_VERSION = 1;
+
+// Converts a text map (one row per line, whitespace-separated tile indices)
+// into the binary format. Rows are streamed, so memory use is one row.
+bool convertTextMap(const std::string& textFile, const std::string& binaryFile, int tileSize);
+
+// Maps a binary map file and validates its header
+class MapFileReader {
+public:
+    bool open(const std::string& path);
+
+    const MapFileHeader& header() const { return *reinterpret_cast<const MapFileHeader*>(file.data()); }
+    const std::uint16_t* tiles() const { return reinterpret_cast<const std::uint16_t*>(file.data() + header().dataOffset); }
+    std::size_t tileCount() const;
+
+private:
+    MappedFile file;
+};
+
+#endif // MAPFILE_H
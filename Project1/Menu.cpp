@@ -0,0 +1,72 @@
+#include "Menu.h"
+#include "Global.hpp"
+#include <string>
+
+namespace {
+
+// Centre a text horizontally at the given height
+void setupText(sf::Text& text, const sf::Font& font, const char* string, unsigned int characterSize, float posY) {
+    text.setFont(font);
+    text.setString(string);
+    text.setCharacterSize(characterSize);
+    text.setFillColor(sf::Color::White);
+    text.setPosition(WINDOW_WIDTH / 2 - text.getGlobalBounds().width / 2, posY);
+}
+
+} // namespace
+
+Menu::Menu(const sf::Font& font)
+    : overlay(sf::Vector2f(WINDOW_WIDTH, WINDOW_HEIGHT)),
+      hasRank(false) {
+    overlay.setFillColor(sf::Color(0, 0, 0, 100));
+
+    // Shown until the sprites needed to play are loaded
+    setupText(loadingText, font, "Loading...", 36, WINDOW_HEIGHT / 2);
+
+    // Pause menu: title with the quit hint some space below it
+    setupText(pauseText, font, "Paused", 48, 0);
+    pauseText.setPosition(pauseText.getPosition().x, WINDOW_HEIGHT / 2 - pauseText.getGlobalBounds().height / 2);
+    setupText(pauseQuitText, font, "Quit Game (Press Q)", 24, pauseText.getPosition().y + 80);
+
+    // Game over menu
+    setupText(gameOverText, font, "Oh no... You died.\nWanna play again?", 36, 0);
+    gameOverText.setPosition(gameOverText.getPosition().x, WINDOW_HEIGHT / 2 - gameOverText.getGlobalBounds().height / 2 - 40);
+    setupText(playAgainText, font, "Play again (Press R)", 24, gameOverText.getPosition().y + 100);
+    setupText(gameOverQuitText, font, "Quit Game (Press Q)", 24, playAgainText.getPosition().y + 60);
+    setupText(rankText, font, "", 24, gameOverQuitText.getPosition().y + 60);
+}
+
+void Menu::setRank(std::uint64_t rank, std::uint64_t entries) {
+    // Laid out once per game over, not per frame
+    std::string text = "Leaderboard: #" + std::to_string(rank + 1) + " of " + std::to_string(entries);
+    setupText(rankText, *rankText.getFont(), text.c_str(), 24, rankText.getPosition().y);
+    hasRank = true;
+}
+
+void Menu::setRankUnavailable() {
+    setupText(rankText, *rankText.getFont(), "Leaderboard unavailable: run not saved", 24, rankText.getPosition().y);
+    hasRank = true;
+}
+
+void Menu::draw(sf::RenderTarget& target, GameState state) const {
+    if (state == GameState::Playing)
+        return;
+
+    if (state == GameState::Loading) {
+        target.draw(loadingText);
+        return;
+    }
+
+    target.draw(overlay);
+    if (state == GameState::Paused) {
+        target.draw(pauseText);
+        target.draw(pauseQuitText);
+    }
+    else {
+        target.draw(gameOverText);
+        target.draw(playAgainText);
+        target.draw(gameOverQuitText);
+        if (hasRank)
+            target.draw(rankText);
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef MENU_H
+#define MENU_H
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+
+// States of the main loop; menus are not separate loops
+enum class GameState {
+    Loading,
+    Playing,
+    Paused,
+    GameOver
+};
+
+// Loading, pause and game-over overlays, laid out once and redrawn from cache.
+// The font is borrowed and must outlive the menu.
+class Menu {
+public:
+    explicit Menu(const sf::Font& font);
+
+    void draw(sf::RenderTarget& target, GameState state) const;
+
+    // Leaderboard placing shown on the game over menu once it is known
+    void setRank(std::uint64_t rank, std::uint64_t entries);
+    // Shown instead when the leaderboard could not store the run
+    void setRankUnavailable();
+    void clearRank() { hasRank = false; }
+
+private:
+    // Create a transparent background shared by both menus
+    sf::RectangleShape overlay;
+
+    sf::Text loadingText;
+
+    sf::Text pauseText;
+    sf::Text pauseQuitText;
+
+    sf::Text gameOverText;
+    sf::Text playAgainText;
+    sf::Text gameOverQuitText;
+    sf::Text rankText;
+    bool hasRank;
+};
+
+#endif // MENU_H
@@ -0,0 +1,118 @@
+#include "NetBots.h"
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "NetClient.h"
+#include "NetServer.h"
+
+namespace {
+
+const float BOT_INPUT_RATE = 60.0f;
+
+struct Bot {
+    std::unique_ptr<NetClient> client;
+    InputState input;
+    int ticksLeft; // Until the bot picks a new direction
+};
+
+std::vector<Bot> connectBots(const sf::IpAddress& server, unsigned short port, int count) {
+    std::vector<Bot> bots;
+    for (int i = 0; i < count; ++i) {
+        Bot bot;
+        bot.client.reset(new NetClient());
+        if (!bot.client->connect(server, port))
+            break;
+        bot.input = InputState{ false, false };
+        bot.ticksLeft = 0;
+        bots.push_back(std::move(bot));
+    }
+    return bots;
+}
+
+// Drives the bots until the deadline; returns the snapshot bytes received
+std::uint64_t driveBots(std::vector<Bot>& bots, SimRandom& random, float seconds) {
+    sf::Clock clock;
+    sf::Time next = sf::Time::Zero;
+    while (clock.getElapsedTime() < sf::seconds(seconds)) {
+        for (Bot& bot : bots) {
+            if (--bot.ticksLeft <= 0) {
+                int direction = random.range(3);
+                bot.input = InputState{ direction == 0, direction == 1 };
+                bot.ticksLeft = 15 + random.range(60);
+            }
+            bot.client->update(bot.input);
+        }
+        next += sf::seconds(1.0f / BOT_INPUT_RATE);
+        sf::Time wait = next - clock.getElapsedTime();
+        if (wait > sf::Time::Zero)
+            sf::sleep(wait);
+    }
+
+    std::uint64_t bytes = 0;
+    for (Bot& bot : bots)
+        bytes += bot.client->getStats().bytesReceived;
+    return bytes;
+}
+
+} // namespace
+
+int runNetBots(const sf::IpAddress& server, unsigned short port, int count, float seconds) {
+    std::vector<Bot> bots = connectBots(server, port, count);
+    if (bots.empty())
+        return 1;
+    if (static_cast<int>(bots.size()) < count)
+        std::cout << "Only " << bots.size() << " of " << count << " bots got a slot" << std::endl;
+
+    SimRandom random(1);
+    std::uint64_t bytes = driveBots(bots, random, seconds);
+
+    std::uint64_t snapshots = 0;
+    std::uint64_t deltas = 0;
+    std::uint64_t undecodable = 0;
+    for (Bot& bot : bots) {
+        const NetClient::Stats& stats = bot.client->getStats();
+        snapshots += stats.snapshots;
+        deltas += stats.deltaSnapshots;
+        undecodable += stats.undecodable;
+    }
+    std::cout << bots.size() << " bots, " << snapshots << " snapshots (" << deltas << " delta, " << undecodable << " undecodable)" << std::endl;
+    std::cout << "Received " << bytes / seconds / bots.size() << " bytes/s per client, "
+              << (snapshots ? bytes / snapshots : 0) << " bytes per snapshot" << std::endl;
+    return snapshots > 0 ? 0 : 1;
+}
+
+int runNetBench(unsigned short port, float secondsPerStep) {
+    std::cout << std::setw(8) << "players" << std::setw(14) << "tick mean us" << std::setw(13) << "tick max us"
+              << std::setw(18) << "bytes/s/client" << std::setw(16) << "bytes/snapshot" << std::setw(9) << "delta %" << std::endl;
+    SimRandom random(1);
+    for (int players = 1; players <= MAX_SIM_PLAYERS; players *= 2) {
+        NetServer server(players);
+        if (!server.bind(port))
+            return 1;
+        std::thread serverThread([&server] { server.run(); });
+
+        std::vector<Bot> bots = connectBots(sf::IpAddress::LocalHost, port, players);
+        // Let every bot settle onto delta snapshots before measuring
+        driveBots(bots, random, 0.5f);
+        server.resetStats();
+        driveBots(bots, random, secondsPerStep);
+        NetServer::Stats stats = server.getStats();
+        server.stop();
+        serverThread.join();
+
+        if (static_cast<int>(bots.size()) != players || stats.ticks == 0 || stats.snapshotsSent == 0) {
+            std::cerr << "Bench step with " << players << " players failed" << std::endl;
+            return 1;
+        }
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(8) << players
+                  << std::setw(14) << stats.tickSeconds / stats.ticks * 1e6
+                  << std::setw(13) << stats.maxTickSeconds * 1e6
+                  << std::setw(18) << stats.bytesSent / secondsPerStep / players
+                  << std::setw(16) << static_cast<double>(stats.bytesSent) / stats.snapshotsSent
+                  << std::setw(9) << 100.0 * stats.deltaSnapshots / stats.snapshotsSent << std::endl;
+    }
+    return 0;
+}
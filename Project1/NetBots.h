@@ -0,0 +1,16 @@
+#ifndef NETBOTS_H
+#define NETBOTS_H
+
+#include <SFML/Network.hpp>
+
+// Bot harness for the multiplayer server.
+// runNetBots connects the given number of bots to a running NetServer; each
+// one wanders left and right and is fed input at 60 Hz from a single thread.
+// Prints snapshot bandwidth per client; returns the process exit code.
+int runNetBots(const sf::IpAddress& server, unsigned short port, int bots, float seconds);
+
+// Runs a server in process and measures it with 1, 2, 4 ... MAX_SIM_PLAYERS
+// bots: server tick time and bytes sent per client per second
+int runNetBench(unsigned short port, float secondsPerStep);
+
+#endif // NETBOTS_H
@@ -0,0 +1,253 @@
+#include "NetClient.h"
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+// Header bytes before the encoded snapshot: type, tick, baseline tick
+const std::size_t SNAPSHOT_HEADER_SIZE = 1 + 4 + 4;
+const double INTERPOLATION_TICKS = NET_INTERPOLATION_DELAY * SIM_TICK_RATE;
+
+float lerp(float from, float to, float t) {
+    return from + (to - from) * t;
+}
+
+} // namespace
+
+NetClient::NetClient()
+    : serverPort(0),
+      connected(false),
+      slot(-1),
+      inputTick(0),
+      history(NET_SNAPSHOT_HISTORY),
+      newestTick(NET_NO_BASELINE),
+      renderTick(0.0) {
+    stats = Stats{ 0, 0, 0, 0 };
+    for (NetSnapshot& snapshot : history)
+        snapshot.tick = NET_NO_BASELINE;
+}
+
+NetClient::~NetClient() {
+    disconnect();
+}
+
+bool NetClient::connect(const sf::IpAddress& host, unsigned short port, sf::Time timeout) {
+    disconnect();
+    if (socket.bind(sf::Socket::AnyPort) != sf::Socket::Done) {
+        std::cerr << "Failed to bind a UDP socket" << std::endl;
+        return false;
+    }
+    socket.setBlocking(false);
+    server = host;
+    serverPort = port;
+
+    sf::Clock clock;
+    sf::Time nextHello = sf::Time::Zero;
+    while (clock.getElapsedTime() < timeout) {
+        if (clock.getElapsedTime() >= nextHello) {
+            sf::Packet hello;
+            hello << static_cast<sf::Uint8>(NetMessage::Hello) << NET_PROTOCOL_VERSION;
+            socket.send(hello, server, serverPort);
+            nextHello += sf::milliseconds(250);
+        }
+
+        sf::Packet reply;
+        sf::IpAddress sender;
+        unsigned short senderPort;
+        if (socket.receive(reply, sender, senderPort) != sf::Socket::Done) {
+            sf::sleep(sf::milliseconds(5));
+            continue;
+        }
+        sf::Uint8 type;
+        if (sender != server || senderPort != serverPort || !(reply >> type))
+            continue;
+        if (type == static_cast<sf::Uint8>(NetMessage::Full)) {
+            std::cerr << "Server " << host << " is full" << std::endl;
+            socket.unbind();
+            return false;
+        }
+        sf::Uint8 assigned;
+        sf::Uint8 slotCount;
+        sf::Uint16 tickRate;
+        if (type == static_cast<sf::Uint8>(NetMessage::Welcome) && reply >> assigned >> slotCount >> tickRate) {
+            if (tickRate != SIM_TICK_RATE) {
+                std::cerr << "Server runs at " << tickRate << " ticks per second, expected " << SIM_TICK_RATE << std::endl;
+                socket.unbind();
+                return false;
+            }
+            slot = assigned;
+            connected = true;
+            lastHeard.restart();
+            return true;
+        }
+    }
+    std::cerr << "No answer from " << host << ":" << port << std::endl;
+    socket.unbind();
+    return false;
+}
+
+void NetClient::disconnect() {
+    if (connected) {
+        sf::Packet bye;
+        bye << static_cast<sf::Uint8>(NetMessage::Bye);
+        socket.send(bye, server, serverPort);
+    }
+    socket.unbind();
+    connected = false;
+    slot = -1;
+    newestTick = NET_NO_BASELINE;
+    for (NetSnapshot& snapshot : history)
+        snapshot.tick = NET_NO_BASELINE;
+}
+
+void NetClient::update(const InputState& input) {
+    if (!connected)
+        return;
+
+    receive();
+    if (lastHeard.getElapsedTime() > sf::seconds(NET_CLIENT_TIMEOUT)) {
+        std::cerr << "Lost connection to " << server << std::endl;
+        connected = false;
+        return;
+    }
+
+    sf::Uint8 bits = (input.left ? NET_INPUT_LEFT : 0) | (input.right ? NET_INPUT_RIGHT : 0);
+    sf::Packet packet;
+    packet << static_cast<sf::Uint8>(NetMessage::Input) << static_cast<sf::Uint32>(inputTick++) << bits << static_cast<sf::Uint32>(newestTick);
+    socket.send(packet, server, serverPort);
+}
+
+void NetClient::receive() {
+    sf::Packet packet;
+    sf::IpAddress sender;
+    unsigned short senderPort;
+    while (socket.receive(packet, sender, senderPort) == sf::Socket::Done) {
+        sf::Uint8 type;
+        sf::Uint32 tick;
+        sf::Uint32 baselineTick;
+        if (sender != server || senderPort != serverPort)
+            continue;
+        if (!(packet >> type) || type != static_cast<sf::Uint8>(NetMessage::Snapshot) || !(packet >> tick >> baselineTick))
+            continue;
+        lastHeard.restart();
+        stats.bytesReceived += packet.getDataSize();
+
+        // Late duplicates of something already held are not worth decoding
+        if (slotFor(tick).tick == tick)
+            continue;
+        const NetSnapshot* baseline = nullptr;
+        if (baselineTick != NET_NO_BASELINE) {
+            baseline = &slotFor(baselineTick);
+            if (baseline->tick != baselineTick) {
+                ++stats.undecodable;
+                continue;
+            }
+        }
+
+        const std::uint8_t* data = static_cast<const std::uint8_t*>(packet.getData()) + SNAPSHOT_HEADER_SIZE;
+        if (!decodeSnapshot(data, packet.getDataSize() - SNAPSHOT_HEADER_SIZE, baseline, decoding)) {
+            ++stats.undecodable;
+            continue;
+        }
+        decoding.tick = tick;
+        ++stats.snapshots;
+        if (baseline)
+            ++stats.deltaSnapshots;
+        store(decoding);
+    }
+}
+
+void NetClient::store(NetSnapshot& decoded) {
+    // Never overwrite a newer snapshot with a reordered older one
+    NetSnapshot& target = slotFor(decoded.tick);
+    if (target.tick != NET_NO_BASELINE && target.tick > decoded.tick)
+        return;
+    std::swap(target, decoded);
+    if (newestTick == NET_NO_BASELINE || target.tick > newestTick) {
+        if (newestTick == NET_NO_BASELINE)
+            renderTick = target.tick - INTERPOLATION_TICKS;
+        newestTick = target.tick;
+    }
+}
+
+const NetSnapshot* NetClient::latest() const {
+    if (newestTick == NET_NO_BASELINE)
+        return nullptr;
+    return &history[(newestTick / NET_TICKS_PER_SNAPSHOT) % NET_SNAPSHOT_HISTORY];
+}
+
+bool NetClient::view(float deltaTime, NetView& out) {
+    const NetSnapshot* newest = latest();
+    if (!newest)
+        return false;
+
+    // The render clock runs at real time and is steered towards staying
+    // INTERPOLATION_TICKS behind the newest snapshot; a large gap (a stall or
+    // a new connection) is closed at once instead
+    renderTick += deltaTime * SIM_TICK_RATE;
+    double target = newestTick - INTERPOLATION_TICKS;
+    if (std::abs(renderTick - target) > INTERPOLATION_TICKS)
+        renderTick = target;
+    else
+        renderTick += (target - renderTick) * 0.05;
+    if (renderTick > newestTick)
+        renderTick = newestTick;
+
+    // The snapshots either side of the render time
+    const NetSnapshot* from = nullptr;
+    const NetSnapshot* to = nullptr;
+    for (const NetSnapshot& snapshot : history) {
+        if (snapshot.tick == NET_NO_BASELINE)
+            continue;
+        if (snapshot.tick <= renderTick && (!from || snapshot.tick > from->tick))
+            from = &snapshot;
+        if (snapshot.tick > renderTick && (!to || snapshot.tick < to->tick))
+            to = &snapshot;
+    }
+    if (!from)
+        from = to;
+    if (!to)
+        to = from;
+    float t = to->tick == from->tick ? 0.0f : static_cast<float>((renderTick - from->tick) / (to->tick - from->tick));
+
+    out.players.resize(to->players.size());
+    for (std::size_t i = 0; i < to->players.size(); ++i) {
+        const NetPlayer& next = to->players[i];
+        NetViewPlayer& player = out.players[i];
+        if (static_cast<int>(i) == slot) {
+            const NetPlayer& own = newest->players[i];
+            player.x = dequantizePosition(own.x);
+            player.frame = own.frame;
+            player.active = (own.flags & NET_PLAYER_ACTIVE) != 0;
+            player.out = (own.flags & NET_PLAYER_OUT) != 0;
+            player.score = own.score;
+            continue;
+        }
+        float nextX = dequantizePosition(next.x);
+        player.x = i < from->players.size() ? lerp(dequantizePosition(from->players[i].x), nextX, t) : nextX;
+        player.frame = next.frame;
+        player.active = (next.flags & NET_PLAYER_ACTIVE) != 0;
+        player.out = (next.flags & NET_PLAYER_OUT) != 0;
+        player.score = next.score;
+    }
+
+    // Items in both snapshots move smoothly; ones only in the later snapshot
+    // pop in where they are. Items only fall, so an id whose y went up is a
+    // recycled slot and not the same item.
+    out.items.resize(to->items.size());
+    std::size_t f = 0;
+    for (std::size_t i = 0; i < to->items.size(); ++i) {
+        const NetItem& next = to->items[i];
+        NetViewItem& item = out.items[i];
+        item.kind = static_cast<ItemKind>(next.kind);
+        item.x = dequantizePosition(next.x);
+        item.y = dequantizePosition(next.y);
+        while (f < from->items.size() && from->items[f].id < next.id)
+            ++f;
+        if (f < from->items.size() && from->items[f].id == next.id && from->items[f].y <= next.y) {
+            item.x = lerp(dequantizePosition(from->items[f].x), item.x, t);
+            item.y = lerp(dequantizePosition(from->items[f].y), item.y, t);
+        }
+    }
+    return true;
+}
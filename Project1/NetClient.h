@@ -0,0 +1,84 @@
+#ifndef NETCLIENT_H
+#define NETCLIENT_H
+
+#include <SFML/Network.hpp>
+#include <cstdint>
+#include <vector>
+#include "GameSim.h"
+#include "NetProtocol.h"
+#include "NetSnapshot.h"
+
+// What the client draws: server state at the current render time
+struct NetViewPlayer {
+    float x;
+    int frame;
+    bool active;
+    bool out;
+    int score;
+};
+
+struct NetViewItem {
+    ItemKind kind;
+    float x;
+    float y;
+};
+
+struct NetView {
+    std::vector<NetViewPlayer> players;
+    std::vector<NetViewItem> items;
+};
+
+// Client side of the multiplayer protocol. update() sends the local input
+// with an ack of the newest snapshot and decodes whatever arrived; view()
+// interpolates remote players and items NET_INTERPOLATION_DELAY behind the
+// newest snapshot. The local player is taken from the newest snapshot as is,
+// so its own movement shows up one round trip late rather than one round trip
+// plus the interpolation delay.
+class NetClient {
+public:
+    struct Stats {
+        std::uint64_t bytesReceived;
+        std::uint64_t snapshots;
+        std::uint64_t deltaSnapshots;
+        std::uint64_t undecodable; // Baseline no longer held, or malformed
+    };
+
+    NetClient();
+    ~NetClient();
+
+    // Sends Hello until the server answers; false if full or no answer in time
+    bool connect(const sf::IpAddress& host, unsigned short port = NET_PORT, sf::Time timeout = sf::seconds(3.0f));
+    void disconnect();
+    // False once the server has been silent for NET_CLIENT_TIMEOUT
+    bool isConnected() const { return connected; }
+    int getSlot() const { return slot; }
+
+    void update(const InputState& input);
+    // Advances the render clock by deltaTime; false until a snapshot has arrived
+    bool view(float deltaTime, NetView& out);
+
+    // The newest decoded snapshot, or nullptr
+    const NetSnapshot* latest() const;
+    const Stats& getStats() const { return stats; }
+
+private:
+    void receive();
+    void store(NetSnapshot& decoded);
+    NetSnapshot& slotFor(std::uint32_t tick) { return history[(tick / NET_TICKS_PER_SNAPSHOT) % NET_SNAPSHOT_HISTORY]; }
+
+    sf::UdpSocket socket;
+    sf::IpAddress server;
+    unsigned short serverPort;
+    bool connected;
+    int slot;
+    std::uint32_t inputTick;
+    sf::Clock lastHeard;
+
+    std::vector<NetSnapshot> history;
+    NetSnapshot decoding;
+    std::uint32_t newestTick; // NET_NO_BASELINE until the first snapshot
+    double renderTick;
+    Stats stats;
+};
+
+#endif // NETCLIENT_H
@@ -0,0 +1,51 @@
+#ifndef NETPROTOCOL_H
+#define NETPROTOCOL_H
+
+#include <SFML/Network.hpp>
+#include <cstdint>
+
+// Datagrams between game clients and the multiplayer server, one sf::Packet each.
+// Client to server:
+//   Hello: protocol version (Uint16)
+//   Input: client tick (Uint32), input bits (Uint8), newest snapshot tick received (Uint32)
+//   Bye
+// Server to client:
+//   Welcome:  player slot (Uint8), slot count (Uint8), tick rate (Uint16)
+//   Full:     no free slot
+//   Snapshot: tick (Uint32), baseline tick (Uint32, NET_NO_BASELINE for a full
+//             snapshot), then the encoded snapshot (see NetSnapshot.h)
+// Every snapshot is a delta against the newest one the client has acknowledged,
+// so a lost datagram costs nothing but a slightly larger next delta.
+enum class NetMessage : sf::Uint8 {
+    Hello,
+    Input,
+    Bye,
+    Welcome,
+    Full,
+    Snapshot
+};
+
+const sf::Uint16 NET_PROTOCOL_VERSION = 1;
+const unsigned short NET_PORT = 53001;
+const std::uint32_t NET_NO_BASELINE = 0xFFFFFFFFu;
+
+// Input bits
+const sf::Uint8 NET_INPUT_LEFT = 1 << 0;
+const sf::Uint8 NET_INPUT_RIGHT = 1 << 1;
+
+// Snapshots sent per second; the simulation runs at SIM_TICK_RATE
+const int NET_SNAPSHOT_RATE = 30;
+// Snapshots both sides keep to delta against; acks older than this get a full snapshot
+const std::size_t NET_SNAPSHOT_HISTORY = 64;
+// Clients not heard from for this long lose their slot
+const float NET_CLIENT_TIMEOUT = 5.0f;
+// Spectators watch over TCP: every frame is a Snapshot message in sf::Packet
+// framing, a delta against the frame before it, with a full keyframe every
+// SPECTATOR_KEYFRAME_INTERVAL frames for late joiners and slow viewers
+const unsigned short SPECTATOR_PORT = 53002;
+const int SPECTATOR_KEYFRAME_INTERVAL = NET_SNAPSHOT_RATE;
+// Remote state is shown this far behind the newest snapshot, so there is
+// nearly always a later snapshot to interpolate towards
+const float NET_INTERPOLATION_DELAY = 0.1f;
+
+#endif // NETPROTOCOL_H
@@ -0,0 +1,237 @@
+#include "NetServer.h"
+#include <algorithm>
+#include <ctime>
+#include <iostream>
+
+namespace {
+
+// Pause between the last player going out and the next round
+const float ROUND_RESTART_DELAY = 3.0f;
+
+GameSimConfig serverConfig(int slots) {
+    GameSimConfig config = GameSim::defaultConfig();
+    config.playerCount = slots;
+    config.seed = static_cast<std::uint32_t>(std::time(nullptr));
+    return config;
+}
+
+} // namespace
+
+NetServer::NetServer(int slots)
+    : sim(serverConfig(slots)),
+      clients(sim.playerCount()),
+      inputs(sim.playerCount()),
+      tick(0),
+      roundOver(false),
+      history(NET_SNAPSHOT_HISTORY),
+      spectators(nullptr),
+      stopping(false),
+      statClients(0) {
+    // Slots are inactive until a client takes them
+    for (int i = 0; i < sim.playerCount(); ++i) {
+        clients[i].connected = false;
+        inputs[i] = InputState{ false, false };
+        sim.setPlayerActive(i, false);
+    }
+    for (NetSnapshot& snapshot : history)
+        snapshot.tick = NET_NO_BASELINE;
+    resetStats();
+}
+
+bool NetServer::bind(unsigned short port) {
+    if (socket.bind(port) != sf::Socket::Done) {
+        std::cerr << "Failed to bind UDP port " << port << std::endl;
+        return false;
+    }
+    socket.setBlocking(false);
+    return true;
+}
+
+void NetServer::run(float seconds) {
+    sf::Time end = clock.getElapsedTime() + sf::seconds(seconds);
+    sf::Time nextTick = clock.getElapsedTime();
+    while (!stopping && (seconds <= 0.0f || clock.getElapsedTime() < end)) {
+        sf::Time wait = nextTick - clock.getElapsedTime();
+        if (wait > sf::Time::Zero)
+            sf::sleep(wait);
+        nextTick += sf::seconds(SIM_TICK);
+
+        sf::Clock tickClock;
+        receive();
+        dropSilentClients();
+
+        // Every player out: show the result for a moment, then a new round
+        if (!sim.isGameOver()) {
+            roundOver = false;
+        }
+        else if (statClients > 0) {
+            if (!roundOver) {
+                roundOver = true;
+                roundOverAt = clock.getElapsedTime();
+            }
+            else if (clock.getElapsedTime() - roundOverAt >= sf::seconds(ROUND_RESTART_DELAY)) {
+                roundOver = false;
+                sim.reset();
+            }
+        }
+        sim.step(SIM_TICK, inputs.data());
+        ++tick;
+        if (tick % NET_TICKS_PER_SNAPSHOT == 0)
+            sendSnapshots();
+
+        std::uint64_t microseconds = static_cast<std::uint64_t>(tickClock.getElapsedTime().asMicroseconds());
+        ++statTicks;
+        statTickMicroseconds += microseconds;
+        if (microseconds > statMaxTickMicroseconds)
+            statMaxTickMicroseconds = microseconds;
+    }
+}
+
+int NetServer::findClient(const sf::IpAddress& address, unsigned short port) const {
+    for (std::size_t i = 0; i < clients.size(); ++i) {
+        if (clients[i].connected && clients[i].port == port && clients[i].address == address)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void NetServer::receive() {
+    sf::Packet packet;
+    sf::IpAddress address;
+    unsigned short port;
+    while (socket.receive(packet, address, port) == sf::Socket::Done) {
+        sf::Uint8 type;
+        if (!(packet >> type))
+            continue;
+        int slot = findClient(address, port);
+
+        if (type == static_cast<sf::Uint8>(NetMessage::Hello)) {
+            sf::Uint16 version;
+            if (!(packet >> version) || version != NET_PROTOCOL_VERSION)
+                continue;
+            // A repeated Hello (the Welcome was lost) gets the same slot again
+            if (slot < 0) {
+                for (std::size_t i = 0; i < clients.size() && slot < 0; ++i) {
+                    if (!clients[i].connected)
+                        slot = static_cast<int>(i);
+                }
+                if (slot >= 0) {
+                    Client& client = clients[slot];
+                    client.connected = true;
+                    client.address = address;
+                    client.port = port;
+                    client.ackedTick = NET_NO_BASELINE;
+                    inputs[slot] = InputState{ false, false };
+                    sim.setPlayerActive(slot, true);
+                    ++statClients;
+                }
+            }
+            sf::Packet reply;
+            if (slot >= 0) {
+                clients[slot].lastHeard = clock.getElapsedTime();
+                reply << static_cast<sf::Uint8>(NetMessage::Welcome) << static_cast<sf::Uint8>(slot)
+                      << static_cast<sf::Uint8>(clients.size()) << static_cast<sf::Uint16>(SIM_TICK_RATE);
+            }
+            else {
+                reply << static_cast<sf::Uint8>(NetMessage::Full);
+            }
+            socket.send(reply, address, port);
+        }
+        else if (slot < 0) {
+            continue;
+        }
+        else if (type == static_cast<sf::Uint8>(NetMessage::Input)) {
+            sf::Uint32 clientTick;
+            sf::Uint8 bits;
+            sf::Uint32 ack;
+            if (!(packet >> clientTick >> bits >> ack))
+                continue;
+            Client& client = clients[slot];
+            client.lastHeard = clock.getElapsedTime();
+            inputs[slot].left = (bits & NET_INPUT_LEFT) != 0;
+            inputs[slot].right = (bits & NET_INPUT_RIGHT) != 0;
+            // Acks can arrive out of order; only move forward
+            if (ack != NET_NO_BASELINE && (client.ackedTick == NET_NO_BASELINE || ack > client.ackedTick) && ack <= tick)
+                client.ackedTick = ack;
+        }
+        else if (type == static_cast<sf::Uint8>(NetMessage::Bye)) {
+            clients[slot].connected = false;
+            sim.setPlayerActive(slot, false);
+            --statClients;
+        }
+    }
+}
+
+void NetServer::dropSilentClients() {
+    sf::Time now = clock.getElapsedTime();
+    for (std::size_t i = 0; i < clients.size(); ++i) {
+        if (clients[i].connected && now - clients[i].lastHeard > sf::seconds(NET_CLIENT_TIMEOUT)) {
+            clients[i].connected = false;
+            sim.setPlayerActive(static_cast<int>(i), false);
+            --statClients;
+        }
+    }
+}
+
+void NetServer::sendSnapshots() {
+    NetSnapshot& snapshot = history[(tick / NET_TICKS_PER_SNAPSHOT) % NET_SNAPSHOT_HISTORY];
+    captureSnapshot(sim, tick, snapshot);
+    if (spectators)
+        spectators->publish(snapshot);
+
+    // Clients acknowledging the same snapshot get the same bytes, encoded once
+    std::vector<std::uint32_t> baselines;
+    std::vector<sf::Packet> packets;
+    for (Client& client : clients) {
+        if (!client.connected)
+            continue;
+
+        std::uint32_t baselineTick = NET_NO_BASELINE;
+        if (client.ackedTick != NET_NO_BASELINE) {
+            const NetSnapshot& acked = history[(client.ackedTick / NET_TICKS_PER_SNAPSHOT) % NET_SNAPSHOT_HISTORY];
+            if (acked.tick == client.ackedTick && acked.tick != tick)
+                baselineTick = acked.tick;
+        }
+
+        std::size_t cached = std::find(baselines.begin(), baselines.end(), baselineTick) - baselines.begin();
+        if (cached == baselines.size()) {
+            const NetSnapshot* baseline = baselineTick == NET_NO_BASELINE ? nullptr
+                : &history[(baselineTick / NET_TICKS_PER_SNAPSHOT) % NET_SNAPSHOT_HISTORY];
+            encodeSnapshot(snapshot, baseline, encoded);
+            sf::Packet packet;
+            packet << static_cast<sf::Uint8>(NetMessage::Snapshot) << static_cast<sf::Uint32>(tick) << static_cast<sf::Uint32>(baselineTick);
+            packet.append(encoded.data(), encoded.size());
+            baselines.push_back(baselineTick);
+            packets.push_back(packet);
+        }
+
+        sf::Packet& packet = packets[cached];
+        if (socket.send(packet, client.address, client.port) == sf::Socket::Done) {
+            statBytesSent += packet.getDataSize();
+            ++statSnapshots;
+            if (baselineTick != NET_NO_BASELINE)
+                ++statDeltaSnapshots;
+        }
+    }
+}
+
+NetServer::Stats NetServer::getStats() const {
+    Stats stats;
+    stats.ticks = statTicks;
+    stats.tickSeconds = statTickMicroseconds / 1e6;
+    stats.maxTickSeconds = statMaxTickMicroseconds / 1e6;
+    stats.bytesSent = statBytesSent;
+    stats.snapshotsSent = statSnapshots;
+    stats.deltaSnapshots = statDeltaSnapshots;
+    stats.clients = statClients;
+    return stats;
+}
+
+void NetServer::resetStats() {
+    statTicks = 0;
+    statTickMicroseconds = 0;
+    statMaxTickMicroseconds = 0;
+    statBytesSent = 0;
+    statSnapshots = 0;
+    statDeltaSnapshots = 0;
+}
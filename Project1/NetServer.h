@@ -0,0 +1,83 @@
+#ifndef NETSERVER_H
+#define NETSERVER_H
+
+#include <SFML/Network.hpp>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "GameSim.h"
+#include "NetProtocol.h"
+#include "NetSnapshot.h"
+#include "SpectatorRelay.h"
+
+// Dedicated multiplayer server: one authoritative GameSim for every player.
+// Steps the simulation at SIM_TICK_RATE with each client's latest input and
+// sends NET_SNAPSHOT_RATE snapshots a second, each delta-encoded against the
+// newest snapshot that client has acknowledged. Clients sharing a baseline
+// share one encoding. A round restarts a few seconds after every player is out.
+class NetServer {
+public:
+    struct Stats {
+        std::uint64_t ticks;
+        double tickSeconds; // Simulation, receive and send time summed over the ticks
+        double maxTickSeconds;
+        std::uint64_t bytesSent;
+        std::uint64_t snapshotsSent;
+        std::uint64_t deltaSnapshots; // Snapshots that had a baseline
+        int clients;
+    };
+
+    explicit NetServer(int slots);
+
+    bool bind(unsigned short port);
+    // Runs for the given time, or until stop() when seconds is 0
+    void run(float seconds = 0.0f);
+    void stop() { stopping = true; }
+    // Every snapshot is also published to the relay's spectators
+    void setSpectatorRelay(SpectatorRelay* relay) { spectators = relay; }
+
+    // Safe to call from another thread; resetStats() starts a new measurement
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    struct Client {
+        bool connected;
+        sf::IpAddress address;
+        unsigned short port;
+        InputState input;
+        std::uint32_t ackedTick; // NET_NO_BASELINE until the first ack
+        sf::Time lastHeard;
+    };
+
+    void receive();
+    int findClient(const sf::IpAddress& address, unsigned short port) const;
+    void sendSnapshots();
+    void dropSilentClients();
+
+    sf::UdpSocket socket;
+    GameSim sim;
+    std::vector<Client> clients;
+    std::vector<InputState> inputs;
+    sf::Clock clock;
+    std::uint32_t tick;
+    sf::Time roundOverAt;
+    bool roundOver;
+
+    // Ring of sent snapshots, indexed by tick / snapshot interval
+    std::vector<NetSnapshot> history;
+    std::vector<std::uint8_t> encoded;
+    SpectatorRelay* spectators;
+    std::atomic<bool> stopping;
+
+    // Written by the server thread, read by getStats()
+    std::atomic<std::uint64_t> statTicks;
+    std::atomic<std::uint64_t> statTickMicroseconds;
+    std::atomic<std::uint64_t> statMaxTickMicroseconds;
+    std::atomic<std::uint64_t> statBytesSent;
+    std::atomic<std::uint64_t> statSnapshots;
+    std::atomic<std::uint64_t> statDeltaSnapshots;
+    std::atomic<int> statClients;
+};
+
+#endif // NETSERVER_H
@@ -0,0 +1,198 @@
+#include "NetSnapshot.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+void putVarint(std::vector<std::uint8_t>& out, std::uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+void putSigned(std::vector<std::uint8_t>& out, std::int32_t value) {
+    putVarint(out, (static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> 31));
+}
+
+// Bounds-checked reads; any overrun leaves the reader failed
+struct Reader {
+    const std::uint8_t* data;
+    std::size_t size;
+    std::size_t position;
+    bool failed;
+
+    std::uint8_t byte() {
+        if (position >= size) {
+            failed = true;
+            return 0;
+        }
+        return data[position++];
+    }
+
+    std::uint32_t varint() {
+        std::uint32_t value = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            std::uint8_t next = byte();
+            value |= static_cast<std::uint32_t>(next & 0x7F) << shift;
+            if (!(next & 0x80))
+                return value;
+        }
+        failed = true;
+        return 0;
+    }
+
+    std::int32_t signedVarint() {
+        std::uint32_t value = varint();
+        return static_cast<std::int32_t>((value >> 1) ^ (0u - (value & 1)));
+    }
+};
+
+const NetPlayer NO_PLAYER = { 0, 0, 0, 0 };
+
+} // namespace
+
+std::uint16_t quantizePosition(float position) {
+    float scaled = std::round(position * NET_POSITION_SCALE);
+    return static_cast<std::uint16_t>(std::max(0.0f, std::min(65535.0f, scaled)));
+}
+
+float dequantizePosition(std::uint16_t position) {
+    return position / NET_POSITION_SCALE;
+}
+
+void captureSnapshot(const GameSim& sim, std::uint32_t tick, NetSnapshot& snapshot) {
+    snapshot.tick = tick;
+    snapshot.players.resize(sim.playerCount());
+    for (int i = 0; i < sim.playerCount(); ++i) {
+        const PlayerState& player = sim.player(i);
+        NetPlayer& net = snapshot.players[i];
+        net.x = quantizePosition(player.posX);
+        net.frame = static_cast<std::uint8_t>(player.currentFrame);
+        net.flags = (player.active ? NET_PLAYER_ACTIVE : 0) | (player.out ? NET_PLAYER_OUT : 0);
+        net.score = player.score;
+    }
+
+    const ItemPool& items = sim.items();
+    snapshot.items.resize(items.size());
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        NetItem& net = snapshot.items[i];
+        net.id = items.entityId[i];
+        net.generation = items.lifecycle().generationOf(net.id);
+        net.kind = static_cast<std::uint8_t>(items.kind[i]);
+        net.x = quantizePosition(items.posX[i]);
+        net.y = quantizePosition(items.posY[i]);
+    }
+    std::sort(snapshot.items.begin(), snapshot.items.end(), [](const NetItem& a, const NetItem& b) { return a.id < b.id; });
+}
+
+void encodeSnapshot(const NetSnapshot& snapshot, const NetSnapshot* baseline, std::vector<std::uint8_t>& out) {
+    out.clear();
+
+    // Players: only the ones that changed since the baseline
+    std::size_t playerCount = snapshot.players.size();
+    bool playersComparable = baseline && baseline->players.size() == playerCount;
+    std::uint32_t changed = 0;
+    for (std::size_t i = 0; i < playerCount; ++i) {
+        const NetPlayer& player = snapshot.players[i];
+        const NetPlayer& before = playersComparable ? baseline->players[i] : NO_PLAYER;
+        if (!playersComparable || player.x != before.x || player.frame != before.frame || player.flags != before.flags || player.score != before.score)
+            changed |= 1u << i;
+    }
+    putVarint(out, static_cast<std::uint32_t>(playerCount));
+    putVarint(out, changed);
+    for (std::size_t i = 0; i < playerCount; ++i) {
+        if (!(changed & (1u << i)))
+            continue;
+        const NetPlayer& player = snapshot.players[i];
+        const NetPlayer& before = playersComparable ? baseline->players[i] : NO_PLAYER;
+        putSigned(out, player.x - before.x);
+        out.push_back(player.frame);
+        out.push_back(player.flags);
+        putSigned(out, player.score - before.score);
+    }
+
+    // Items: both lists are sorted by id, so matching is one merge pass
+    putVarint(out, static_cast<std::uint32_t>(snapshot.items.size()));
+    std::size_t b = 0;
+    std::uint32_t previousId = 0;
+    for (const NetItem& item : snapshot.items) {
+        while (baseline && b < baseline->items.size() && baseline->items[b].id < item.id)
+            ++b;
+        const NetItem* before = baseline && b < baseline->items.size() && baseline->items[b].id == item.id
+            && baseline->items[b].generation == item.generation ? &baseline->items[b] : nullptr;
+
+        std::uint32_t idDelta = item.id - previousId;
+        previousId = item.id;
+        if (!before) {
+            putVarint(out, idDelta << 2 | 1);
+            out.push_back(item.kind);
+            putVarint(out, item.x);
+            putVarint(out, item.y);
+        }
+        else {
+            bool moved = item.x != before->x;
+            putVarint(out, idDelta << 2 | (moved ? 2u : 0u));
+            if (moved)
+                putSigned(out, item.x - before->x);
+            putSigned(out, item.y - before->y);
+        }
+    }
+}
+
+bool decodeSnapshot(const std::uint8_t* data, std::size_t size, const NetSnapshot* baseline, NetSnapshot& snapshot) {
+    Reader reader = { data, size, 0, false };
+
+    std::uint32_t playerCount = reader.varint();
+    if (playerCount > static_cast<std::uint32_t>(MAX_SIM_PLAYERS))
+        return false;
+    bool playersComparable = baseline && baseline->players.size() == playerCount;
+    std::uint32_t changed = reader.varint();
+    snapshot.players.resize(playerCount);
+    for (std::uint32_t i = 0; i < playerCount; ++i) {
+        NetPlayer& player = snapshot.players[i];
+        player = playersComparable ? baseline->players[i] : NO_PLAYER;
+        if (!(changed & (1u << i))) {
+            if (!playersComparable)
+                return false;
+            continue;
+        }
+        player.x = static_cast<std::uint16_t>(player.x + reader.signedVarint());
+        player.frame = reader.byte();
+        player.flags = reader.byte();
+        player.score += reader.signedVarint();
+    }
+
+    std::uint32_t itemCount = reader.varint();
+    if (reader.failed || itemCount > size) // Every item takes at least a byte
+        return false;
+    snapshot.items.resize(itemCount);
+    std::size_t b = 0;
+    std::uint32_t id = 0;
+    for (NetItem& item : snapshot.items) {
+        std::uint32_t header = reader.varint();
+        id += header >> 2;
+        item.id = id;
+        item.generation = 0;
+        if (header & 1) {
+            item.kind = reader.byte();
+            // The client indexes its sprite table with the kind
+            if (item.kind >= static_cast<std::uint8_t>(ItemKind::Count))
+                return false;
+            item.x = static_cast<std::uint16_t>(reader.varint());
+            item.y = static_cast<std::uint16_t>(reader.varint());
+            continue;
+        }
+
+        while (baseline && b < baseline->items.size() && baseline->items[b].id < id)
+            ++b;
+        if (!baseline || b == baseline->items.size() || baseline->items[b].id != id)
+            return false;
+        const NetItem& before = baseline->items[b];
+        item.kind = before.kind;
+        item.x = static_cast<std::uint16_t>(before.x + ((header & 2) ? reader.signedVarint() : 0));
+        item.y = static_cast<std::uint16_t>(before.y + reader.signedVarint());
+    }
+    return !reader.failed;
+}
@@ -0,0 +1,61 @@
+#ifndef NETSNAPSHOT_H
+#define NETSNAPSHOT_H
+
+#include <cstdint>
+#include <vector>
+#include "GameSim.h"
+#include "NetProtocol.h"
+
+// Positions travel as fixed point with NET_POSITION_SCALE steps per pixel
+const float NET_POSITION_SCALE = 8.0f;
+
+// The server snapshots every NET_TICKS_PER_SNAPSHOT simulation ticks
+const int NET_TICKS_PER_SNAPSHOT = SIM_TICK_RATE / NET_SNAPSHOT_RATE;
+
+std::uint16_t quantizePosition(float position);
+float dequantizePosition(std::uint16_t position);
+
+// Player flags
+const std::uint8_t NET_PLAYER_ACTIVE = 1 << 0;
+const std::uint8_t NET_PLAYER_OUT = 1 << 1;
+
+struct NetPlayer {
+    std::uint16_t x;
+    std::uint8_t frame;
+    std::uint8_t flags;
+    std::int32_t score;
+};
+
+struct NetItem {
+    std::uint32_t id; // EntityLifecycle id
+    std::uint32_t generation; // Server side only: a recycled id is a new item
+    std::uint8_t kind;
+    std::uint16_t x;
+    std::uint16_t y;
+};
+
+// Quantized world state at one tick; items sorted by id
+struct NetSnapshot {
+    std::uint32_t tick;
+    std::vector<NetPlayer> players;
+    std::vector<NetItem> items;
+};
+
+// Copy the simulation into a snapshot, reusing its storage
+void captureSnapshot(const GameSim& sim, std::uint32_t tick, NetSnapshot& snapshot);
+
+// Encoded snapshot layout (varints are LEB128, signed ones zigzag first):
+//   player count (varint), changed-player mask (varint)
+//   per changed player: x delta (signed), frame (byte), flags (byte), score delta (signed)
+//   item count (varint)
+//   per item, by id: (id delta << 2 | has x delta << 1 | is new) (varint), then
+//     new:      kind (byte), x (varint), y (varint)
+//     existing: [x delta (signed)], y delta (signed)
+// Deltas are against the baseline; with no baseline everything is new. Items
+// only fall, so an existing item costs two or three bytes instead of nine.
+void encodeSnapshot(const NetSnapshot& snapshot, const NetSnapshot* baseline, std::vector<std::uint8_t>& out);
+// False if the data is malformed, has an unknown item kind or refers to items
+// the baseline does not have
+bool decodeSnapshot(const std::uint8_t* data, std::size_t size, const NetSnapshot* baseline, NetSnapshot& snapshot);
+
+#endif // NETSNAPSHOT_H
@@ -0,0 +1,179 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <ctime>
+#endif
+
+namespace {
+
+const char* PHASE_NAMES[static_cast<int>(ProfilePhase::Count)] = {
+    "events", "input", "player", "spawn", "collision", "items", "assets", "draw", "display"
+};
+
+const char* COUNTER_NAMES[static_cast<int>(ProfileCounter::Count)] = {
+    "voices_active", "voices_stolen", "voices_dropped"
+};
+
+// Value at a fraction of the way through a sorted list
+float percentile(const std::vector<float>& sorted, float fraction) {
+    std::size_t index = static_cast<std::size_t>(fraction * (sorted.size() - 1) + 0.5f);
+    return sorted[index];
+}
+
+void printStatsRow(std::ostream& out, const char* name, std::vector<float>& values) {
+    std::sort(values.begin(), values.end());
+    double sum = 0.0;
+    for (float value : values)
+        sum += value;
+    out << std::setw(10) << name
+        << std::setw(10) << sum / values.size()
+        << std::setw(10) << percentile(values, 0.5f)
+        << std::setw(10) << percentile(values, 0.99f)
+        << std::setw(10) << values.back() << std::endl;
+}
+
+} // namespace
+
+const char* profilePhaseName(ProfilePhase phase) {
+    return PHASE_NAMES[static_cast<int>(phase)];
+}
+
+const char* profileCounterName(ProfileCounter counter) {
+    return COUNTER_NAMES[static_cast<int>(counter)];
+}
+
+double processCpuSeconds() {
+#ifdef _WIN32
+    // clock() is wall time on Windows, so ask for the process times directly
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+        return 0.0;
+    ULARGE_INTEGER kernelTicks, userTicks;
+    kernelTicks.LowPart = kernel.dwLowDateTime;
+    kernelTicks.HighPart = kernel.dwHighDateTime;
+    userTicks.LowPart = user.dwLowDateTime;
+    userTicks.HighPart = user.dwHighDateTime;
+    return static_cast<double>(kernelTicks.QuadPart + userTicks.QuadPart) * 100e-9;
+#else
+    return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+Profiler& Profiler::instance() {
+    thread_local Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler()
+    : head(0),
+      count(0),
+      csvSink(nullptr) {
+    std::memset(&current, 0, sizeof(current));
+    frameStart = std::chrono::steady_clock::now();
+}
+
+void Profiler::beginFrame() {
+    std::uint64_t index = current.index;
+    std::memset(&current, 0, sizeof(current));
+    current.index = index;
+    frameStart = std::chrono::steady_clock::now();
+}
+
+void Profiler::endFrame() {
+    std::chrono::duration<float, std::micro> elapsed = std::chrono::steady_clock::now() - frameStart;
+    current.total = elapsed.count();
+
+    history[head] = current;
+    head = (head + 1) % HISTORY_FRAMES;
+    if (count < HISTORY_FRAMES)
+        ++count;
+    if (csvSink)
+        writeCsvRow(*csvSink, current);
+    ++current.index;
+}
+
+void Profiler::addTime(ProfilePhase phase, float microseconds) {
+    current.phases[static_cast<int>(phase)] += microseconds;
+}
+
+const ProfileFrame& Profiler::frame(std::size_t age) const {
+    return history[(head + HISTORY_FRAMES - 1 - age) % HISTORY_FRAMES];
+}
+
+void Profiler::setCsvSink(std::ostream* sink) {
+    csvSink = sink;
+    if (csvSink)
+        writeCsvHeader(*csvSink);
+}
+
+void Profiler::writeCsv(std::ostream& out) const {
+    writeCsvHeader(out);
+    for (std::size_t age = count; age-- > 0;)
+        writeCsvRow(out, frame(age));
+}
+
+void Profiler::writeCsvHeader(std::ostream& out) {
+    out << "frame,total_us";
+    for (int phase = 0; phase < static_cast<int>(ProfilePhase::Count); ++phase)
+        out << ',' << PHASE_NAMES[phase] << "_us";
+    for (int counter = 0; counter < static_cast<int>(ProfileCounter::Count); ++counter)
+        out << ',' << COUNTER_NAMES[counter];
+    out << '\n';
+}
+
+void Profiler::writeCsvRow(std::ostream& out, const ProfileFrame& frame) {
+    out << frame.index << ',' << frame.total;
+    for (int phase = 0; phase < static_cast<int>(ProfilePhase::Count); ++phase)
+        out << ',' << frame.phases[phase];
+    for (int counter = 0; counter < static_cast<int>(ProfileCounter::Count); ++counter)
+        out << ',' << frame.counters[counter];
+    out << '\n';
+}
+
+void ProfileSummary::print(std::ostream& out, float framesPerSecond, std::size_t slowestFrames) const {
+    if (frames.empty()) {
+        out << "No frames profiled" << std::endl;
+        return;
+    }
+
+    out << std::fixed << std::setprecision(2);
+    out << std::setw(10) << "us" << std::setw(10) << "mean" << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10) << "max" << std::endl;
+    std::vector<float> values(frames.size());
+    for (std::size_t i = 0; i < frames.size(); ++i)
+        values[i] = frames[i].total;
+    printStatsRow(out, "total", values);
+    for (int phase = 0; phase < static_cast<int>(ProfilePhase::Count); ++phase) {
+        bool used = false;
+        for (std::size_t i = 0; i < frames.size(); ++i) {
+            values[i] = frames[i].phases[phase];
+            used = used || values[i] > 0.0f;
+        }
+        if (used)
+            printStatsRow(out, PHASE_NAMES[phase], values);
+    }
+
+    // The slowest frames and when they happened
+    std::vector<const ProfileFrame*> slowest(frames.size());
+    for (std::size_t i = 0; i < frames.size(); ++i)
+        slowest[i] = &frames[i];
+    slowestFrames = std::min(slowestFrames, slowest.size());
+    std::partial_sort(slowest.begin(), slowest.begin() + slowestFrames, slowest.end(),
+        [](const ProfileFrame* a, const ProfileFrame* b) { return a->total > b->total; });
+    out << "Slowest frames:" << std::endl;
+    for (std::size_t i = 0; i < slowestFrames; ++i) {
+        const ProfileFrame& frame = *slowest[i];
+        int worstPhase = 0;
+        for (int phase = 1; phase < static_cast<int>(ProfilePhase::Count); ++phase) {
+            if (frame.phases[phase] > frame.phases[worstPhase])
+                worstPhase = phase;
+        }
+        out << "  frame " << frame.index << " at " << frame.index / framesPerSecond << " s: "
+            << frame.total << " us, mostly " << PHASE_NAMES[worstPhase] << std::endl;
+    }
+}
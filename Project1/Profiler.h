@@ -0,0 +1,142 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Build with PROFILER_ENABLED=0 to compile every PROFILE_* macro out
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+// Parts of a frame; simulation phases add up over every tick run in the frame
+enum class ProfilePhase : std::uint8_t {
+    Events,
+    Input,
+    Player,
+    Spawn,
+    Collision,
+    Items,
+    Assets,
+    Draw,
+    Display,
+    Count
+};
+
+const char* profilePhaseName(ProfilePhase phase);
+
+// Things counted per frame next to the timings
+enum class ProfileCounter : std::uint8_t {
+    VoicesActive,  // Sound voices playing at the end of the frame
+    VoicesStolen,  // Voices cut short for a new sound
+    VoicesDropped, // Sounds not played because every voice was more important
+    Count
+};
+
+const char* profileCounterName(ProfileCounter counter);
+
+// CPU time used so far by every thread of the process, user and kernel, in seconds
+double processCpuSeconds();
+
+// Microseconds spent in one frame, in total and per phase, and the frame's counters
+struct ProfileFrame {
+    std::uint64_t index;
+    float total;
+    float phases[static_cast<int>(ProfilePhase::Count)];
+    std::uint32_t counters[static_cast<int>(ProfileCounter::Count)];
+};
+
+// Per-frame phase timings and counters in a fixed-size ring buffer.
+// There is one profiler per thread so that the simulation and the main
+// loop can both be timed without passing it around, and a simulation run
+// on a worker (a server thread, say) records into its own thread's profiler
+// instead of racing the main loop's. Frames can also be streamed to a CSV
+// sink as they complete, for headless runs longer than the history.
+class Profiler {
+public:
+    static const std::size_t HISTORY_FRAMES = 240;
+
+    // The calling thread's profiler
+    static Profiler& instance();
+
+    void beginFrame();
+    void endFrame();
+    void addTime(ProfilePhase phase, float microseconds);
+    void addCount(ProfileCounter counter, std::uint32_t amount) { current.counters[static_cast<int>(counter)] += amount; }
+    void setCount(ProfileCounter counter, std::uint32_t value) { current.counters[static_cast<int>(counter)] = value; }
+
+    // Completed frames held, up to HISTORY_FRAMES; age 0 is the most recent
+    std::size_t frameCount() const { return count; }
+    const ProfileFrame& frame(std::size_t age) const;
+
+    // Write a header now and every completed frame from then on; nullptr stops
+    void setCsvSink(std::ostream* sink);
+    // Write the frames in the history, oldest first
+    void writeCsv(std::ostream& out) const;
+
+private:
+    Profiler();
+
+    static void writeCsvHeader(std::ostream& out);
+    static void writeCsvRow(std::ostream& out, const ProfileFrame& frame);
+
+    ProfileFrame history[HISTORY_FRAMES];
+    std::size_t head; // Slot the next completed frame goes to
+    std::size_t count;
+    ProfileFrame current;
+    std::chrono::steady_clock::time_point frameStart;
+    std::ostream* csvSink;
+};
+
+// Keeps every frame of a run, however long, and reports per-phase
+// percentiles and the slowest frames, for finding where a stutter starts
+class ProfileSummary {
+public:
+    void add(const ProfileFrame& frame) { frames.push_back(frame); }
+    std::size_t frameCount() const { return frames.size(); }
+
+    // framesPerSecond turns frame indices into time into the run
+    void print(std::ostream& out, float framesPerSecond, std::size_t slowestFrames = 5) const;
+
+private:
+    std::vector<ProfileFrame> frames;
+};
+
+// Adds the time until the end of the enclosing scope to a phase
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfilePhase phase)
+        : phase(phase), start(std::chrono::steady_clock::now()) {
+    }
+    ~ProfileScope() {
+        std::chrono::duration<float, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        Profiler::instance().addTime(phase, elapsed.count());
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    ProfilePhase phase;
+    std::chrono::steady_clock::time_point start;
+};
+
+#if PROFILER_ENABLED
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(phase) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(phase)
+#define PROFILE_FRAME_BEGIN() Profiler::instance().beginFrame()
+#define PROFILE_FRAME_END() Profiler::instance().endFrame()
+#define PROFILE_COUNT(counter, amount) Profiler::instance().addCount(counter, amount)
+#define PROFILE_SET_COUNT(counter, value) Profiler::instance().setCount(counter, value)
+#else
+#define PROFILE_SCOPE(phase) ((void)0)
+#define PROFILE_FRAME_BEGIN() ((void)0)
+#define PROFILE_FRAME_END() ((void)0)
+#define PROFILE_COUNT(counter, amount) ((void)0)
+#define PROFILE_SET_COUNT(counter, value) ((void)0)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,169 @@
+#include "ProfilerOverlay.h"
+#include "Global.hpp"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+const float PANEL_WIDTH = 500.0f;
+const float PANEL_HEIGHT = 450.0f;
+const float PANEL_LEFT = WINDOW_WIDTH - PANEL_WIDTH - 10.0f;
+const float PANEL_TOP = 10.0f;
+const float PADDING = 10.0f;
+const float GRAPH_HEIGHT = 140.0f;
+const float GRAPH_FULL_SCALE_US = 33333.0f; // Two 60 Hz frames fill the graph
+const float BAR_HEIGHT = 14.0f;
+const float BAR_SPACING = 24.0f;
+const float BAR_LEFT = PANEL_LEFT + 130.0f;
+const float BAR_MAX_WIDTH = PANEL_WIDTH - 140.0f - PADDING;
+const float BAR_FULL_SCALE_US = 8000.0f;
+const unsigned int LABEL_INTERVAL_FRAMES = 15;
+
+const sf::Color PHASE_COLORS[static_cast<int>(ProfilePhase::Count)] = {
+    sf::Color(120, 120, 255), // events
+    sf::Color(80, 200, 255),  // input
+    sf::Color(80, 220, 120),  // player
+    sf::Color(200, 240, 80),  // spawn
+    sf::Color(255, 200, 60),  // collision
+    sf::Color(255, 140, 60),  // items
+    sf::Color(200, 100, 255), // assets
+    sf::Color(255, 80, 80),   // draw
+    sf::Color(160, 160, 160)  // display
+};
+const sf::Color UNTRACKED_COLOR(70, 70, 70);
+
+void appendRect(sf::VertexArray& vertices, float left, float top, float width, float height, sf::Color color) {
+    sf::Vertex topLeft(sf::Vector2f(left, top), color);
+    sf::Vertex topRight(sf::Vector2f(left + width, top), color);
+    sf::Vertex bottomLeft(sf::Vector2f(left, top + height), color);
+    sf::Vertex bottomRight(sf::Vector2f(left + width, top + height), color);
+    vertices.append(topLeft);
+    vertices.append(topRight);
+    vertices.append(bottomLeft);
+    vertices.append(bottomLeft);
+    vertices.append(topRight);
+    vertices.append(bottomRight);
+}
+
+} // namespace
+
+ProfilerOverlay::ProfilerOverlay(const sf::Font& font)
+    : visible(false),
+      framesSinceLabels(LABEL_INTERVAL_FRAMES),
+      panel(sf::Vector2f(PANEL_WIDTH, PANEL_HEIGHT)),
+      graph(sf::Triangles),
+      bars(sf::Triangles) {
+    panel.setPosition(PANEL_LEFT, PANEL_TOP);
+    panel.setFillColor(sf::Color(0, 0, 0, 180));
+
+    summary.setFont(font);
+    summary.setCharacterSize(16);
+    summary.setPosition(PANEL_LEFT + PADDING, PANEL_TOP + PADDING + GRAPH_HEIGHT + 6.0f);
+
+    float barsTop = PANEL_TOP + PADDING + GRAPH_HEIGHT + 36.0f;
+    for (int phase = 0; phase < static_cast<int>(ProfilePhase::Count); ++phase) {
+        phaseLabels[phase].setFont(font);
+        phaseLabels[phase].setCharacterSize(14);
+        phaseLabels[phase].setFillColor(PHASE_COLORS[phase]);
+        phaseLabels[phase].setPosition(PANEL_LEFT + PADDING, barsTop + phase * BAR_SPACING - 2.0f);
+    }
+
+    counterLabel.setFont(font);
+    counterLabel.setCharacterSize(14);
+    counterLabel.setPosition(PANEL_LEFT + PADDING, barsTop + static_cast<int>(ProfilePhase::Count) * BAR_SPACING);
+}
+
+void ProfilerOverlay::draw(sf::RenderTarget& target) {
+    if (!visible)
+        return;
+
+    rebuild();
+    target.draw(panel);
+    target.draw(graph);
+    target.draw(bars);
+    target.draw(summary);
+    for (const sf::Text& label : phaseLabels)
+        target.draw(label);
+    target.draw(counterLabel);
+}
+
+void ProfilerOverlay::rebuild() {
+    const Profiler& profiler = Profiler::instance();
+    std::size_t frames = profiler.frameCount();
+    float barWidth = (PANEL_WIDTH - 2 * PADDING) / Profiler::HISTORY_FRAMES;
+    float graphBottom = PANEL_TOP + PADDING + GRAPH_HEIGHT;
+    float pixelsPerUs = GRAPH_HEIGHT / GRAPH_FULL_SCALE_US;
+
+    // Rolling graph, newest frame on the right
+    graph.clear();
+    float averages[static_cast<int>(ProfilePhase::Count)] = {};
+    float averageTotal = 0.0f, worstTotal = 0.0f;
+    for (std::size_t age = 0; age < frames; ++age) {
+        const ProfileFrame& frame = profiler.frame(age);
+        float left = PANEL_LEFT + PANEL_WIDTH - PADDING - (age + 1) * barWidth;
+        float top = graphBottom;
+        float tracked = 0.0f;
+        for (int phase = 0; phase < static_cast<int>(ProfilePhase::Count); ++phase) {
+            float height = std::min(frame.phases[phase] * pixelsPerUs, top - (graphBottom - GRAPH_HEIGHT));
+            top -= height;
+            appendRect(graph, left, top, barWidth, height, PHASE_COLORS[phase]);
+            tracked += frame.phases[phase];
+            averages[phase] += frame.phases[phase];
+        }
+        // Whatever no scope covered (e.g. vsync waits outside display)
+        float untracked = std::min(std::max(0.0f, frame.total - tracked) * pixelsPerUs, top - (graphBottom - GRAPH_HEIGHT));
+        appendRect(graph, left, top - untracked, barWidth, untracked, UNTRACKED_COLOR);
+        averageTotal += frame.total;
+        worstTotal = std::max(worstTotal, frame.total);
+    }
+    // 60 Hz budget line
+    appendRect(graph, PANEL_LEFT + PADDING, graphBottom - 16667.0f * pixelsPerUs, PANEL_WIDTH - 2 * PADDING, 1.0f, sf::Color::White);
+
+    if (frames > 0) {
+        for (float& average : averages)
+            average /= frames;
+        averageTotal /= frames;
+    }
+
+    // One bar per phase with its average cost
+    bars.clear();
+    float barsTop = PANEL_TOP + PADDING + GRAPH_HEIGHT + 36.0f;
+    for (int phase = 0; phase < static_cast<int>(ProfilePhase::Count); ++phase) {
+        float width = std::min(averages[phase] / BAR_FULL_SCALE_US, 1.0f) * BAR_MAX_WIDTH;
+        appendRect(bars, BAR_LEFT, barsTop + phase * BAR_SPACING, std::max(width, 1.0f), BAR_HEIGHT, PHASE_COLORS[phase]);
+    }
+
+    if (++framesSinceLabels >= LABEL_INTERVAL_FRAMES) {
+        updateLabels(averages, averageTotal, worstTotal);
+        updateCounterLabel();
+        framesSinceLabels = 0;
+    }
+}
+
+void ProfilerOverlay::updateLabels(const float* averages, float averageTotal, float worstTotal) {
+    char buffer[96];
+    std::snprintf(buffer, sizeof(buffer), "frame avg %.2f ms  worst %.2f ms  (F3 to hide)", averageTotal / 1000.0f, worstTotal / 1000.0f);
+    summary.setString(buffer);
+    for (int phase = 0; phase < static_cast<int>(ProfilePhase::Count); ++phase) {
+        std::snprintf(buffer, sizeof(buffer), "%-9s %6.3f", profilePhaseName(static_cast<ProfilePhase>(phase)), averages[phase] / 1000.0f);
+        phaseLabels[phase].setString(buffer);
+    }
+}
+
+void ProfilerOverlay::updateCounterLabel() {
+    // Voices playing now and at the peak, and how many were stolen or dropped over the history
+    const Profiler& profiler = Profiler::instance();
+    std::uint32_t active = 0, peak = 0, stolen = 0, dropped = 0;
+    for (std::size_t age = 0; age < profiler.frameCount(); ++age) {
+        const ProfileFrame& frame = profiler.frame(age);
+        if (age == 0)
+            active = frame.counters[static_cast<int>(ProfileCounter::VoicesActive)];
+        peak = std::max(peak, frame.counters[static_cast<int>(ProfileCounter::VoicesActive)]);
+        stolen += frame.counters[static_cast<int>(ProfileCounter::VoicesStolen)];
+        dropped += frame.counters[static_cast<int>(ProfileCounter::VoicesDropped)];
+    }
+    char buffer[96];
+    std::snprintf(buffer, sizeof(buffer), "voices %u (peak %u)  stolen %u  dropped %u",
+        static_cast<unsigned int>(active), static_cast<unsigned int>(peak), static_cast<unsigned int>(stolen), static_cast<unsigned int>(dropped));
+    counterLabel.setString(buffer);
+}
@@ -0,0 +1,34 @@
+#ifndef PROFILEROVERLAY_H
+#define PROFILEROVERLAY_H
+
+#include <SFML/Graphics.hpp>
+#include "Profiler.h"
+
+// Profiler view drawn over the game: a rolling graph of the frames in the
+// profiler's history, each bar stacked by phase, and one bar per phase with
+// its average over the history, then a line of counters. Geometry is only rebuilt while visible and
+// the labels only every few frames. The font is borrowed.
+class ProfilerOverlay {
+public:
+    explicit ProfilerOverlay(const sf::Font& font);
+
+    void toggle() { visible = !visible; }
+    bool isVisible() const { return visible; }
+    void draw(sf::RenderTarget& target);
+
+private:
+    void rebuild();
+    void updateLabels(const float* averages, float averageTotal, float worstTotal);
+    void updateCounterLabel();
+
+    bool visible;
+    unsigned int framesSinceLabels;
+    sf::RectangleShape panel;
+    sf::VertexArray graph;
+    sf::VertexArray bars;
+    sf::Text summary;
+    sf::Text phaseLabels[static_cast<int>(ProfilePhase::Count)];
+    sf::Text counterLabel;
+};
+
+#endif // PROFILEROVERLAY_H
@@ -0,0 +1,203 @@
+#include "ResourceCache.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+
+namespace {
+
+// A font and the bytes FreeType reads glyphs from for as long as the font lives:
+// either its own copy of the file or the mounted pack
+struct FontData {
+    std::vector<char> file;
+    std::shared_ptr<const AssetPack> pack;
+    sf::Font font;
+};
+
+const char* typeName(ResourceType type) {
+    switch (type) {
+    case ResourceType::Texture: return "texture";
+    case ResourceType::Font: return "font";
+    default: return "sound";
+    }
+}
+
+std::size_t textureBytes(const sf::Texture& texture) {
+    return static_cast<std::size_t>(texture.getSize().x) * texture.getSize().y * 4;
+}
+
+} // namespace
+
+ResourceCache::ResourceCache()
+    : useCounter(0),
+      fileReads(0),
+      packLoads(0) {
+}
+
+ResourceCache::Entry* ResourceCache::find(const std::string& key, ResourceType type) {
+    auto it = entries.find(key);
+    if (it == entries.end())
+        return nullptr;
+    if (it->second.type != type) {
+        std::cerr << "Resource " << key << " is cached as a " << typeName(it->second.type)
+                  << ", not a " << typeName(type) << std::endl;
+        return nullptr;
+    }
+    it->second.lastUse = ++useCounter;
+    return &it->second;
+}
+
+void ResourceCache::insert(const std::string& key, ResourceType type, std::shared_ptr<const void> resource,
+                           std::size_t cpuBytes, std::size_t gpuBytes) {
+    Entry entry;
+    entry.type = type;
+    entry.resource = std::move(resource);
+    entry.cpuBytes = cpuBytes;
+    entry.gpuBytes = gpuBytes;
+    entry.lastUse = ++useCounter;
+    entries[key] = std::move(entry);
+}
+
+TextureHandle ResourceCache::getTexture(const std::string& file) {
+    if (Entry* entry = find(file, ResourceType::Texture))
+        return std::static_pointer_cast<const sf::Texture>(entry->resource);
+    if (entries.count(file))
+        return TextureHandle(); // Cached as another type
+
+    std::shared_ptr<sf::Texture> texture = std::make_shared<sf::Texture>();
+    bool packed = pack && pack->contains(file);
+    ++(packed ? packLoads : fileReads);
+    if (packed ? !pack->loadTexture(file, *texture) : !texture->loadFromFile(file)) {
+        std::cerr << "Failed to load texture: " << file << std::endl;
+        return TextureHandle();
+    }
+    insert(file, ResourceType::Texture, texture, 0, textureBytes(*texture));
+    return texture;
+}
+
+FontHandle ResourceCache::getFont(const std::string& file) {
+    if (Entry* entry = find(file, ResourceType::Font))
+        return std::static_pointer_cast<const sf::Font>(entry->resource);
+    if (entries.count(file))
+        return FontHandle(); // Cached as another type
+
+    std::shared_ptr<FontData> data = std::make_shared<FontData>();
+    bool loaded;
+    if (pack && pack->contains(file)) {
+        ++packLoads;
+        data->pack = pack;
+        loaded = pack->loadFont(file, data->font);
+    }
+    else {
+        // Read the file once; loadFromFile would keep reopening it as glyphs are rasterized
+        ++fileReads;
+        std::ifstream stream(file, std::ios::binary);
+        data->file.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+        loaded = !data->file.empty() && data->font.loadFromMemory(data->file.data(), data->file.size());
+    }
+    if (!loaded) {
+        std::cerr << "Failed to load font file: " << file << std::endl;
+        return FontHandle();
+    }
+
+    // Aliasing handle: points at the font, keeps the file bytes alive with it
+    FontHandle font(data, &data->font);
+    insert(file, ResourceType::Font, font, data->file.size(), 0);
+    return font;
+}
+
+SoundBufferHandle ResourceCache::getSoundBuffer(const std::string& file) {
+    if (Entry* entry = find(file, ResourceType::SoundBuffer))
+        return std::static_pointer_cast<const sf::SoundBuffer>(entry->resource);
+    if (entries.count(file))
+        return SoundBufferHandle(); // Cached as another type
+
+    std::shared_ptr<sf::SoundBuffer> buffer = std::make_shared<sf::SoundBuffer>();
+    sf::MemoryInputStream stream;
+    bool packed = pack && pack->openStream(file, stream);
+    ++(packed ? packLoads : fileReads);
+    if (packed ? !buffer->loadFromStream(stream) : !buffer->loadFromFile(file)) {
+        std::cerr << "Failed to load sound file: " << file << std::endl;
+        return SoundBufferHandle();
+    }
+    insert(file, ResourceType::SoundBuffer, buffer, static_cast<std::size_t>(buffer->getSampleCount()) * sizeof(sf::Int16), 0);
+    return buffer;
+}
+
+TextureHandle ResourceCache::addTexture(const std::string& key, std::shared_ptr<sf::Texture> texture) {
+    insert(key, ResourceType::Texture, texture, 0, textureBytes(*texture));
+    return texture;
+}
+
+TextureHandle ResourceCache::findTexture(const std::string& key) {
+    if (Entry* entry = find(key, ResourceType::Texture))
+        return std::static_pointer_cast<const sf::Texture>(entry->resource);
+    return TextureHandle();
+}
+
+std::size_t ResourceCache::evictUnused(std::size_t budgetBytes) {
+    std::size_t total = getTotalBytes();
+    if (total <= budgetBytes)
+        return 0;
+
+    // Only the cache's own reference left: nobody is using it
+    std::vector<std::map<std::string, Entry>::iterator> unused;
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (it->second.resource.use_count() == 1)
+            unused.push_back(it);
+    }
+    std::sort(unused.begin(), unused.end(), [](const std::map<std::string, Entry>::iterator& a, const std::map<std::string, Entry>::iterator& b) {
+        return a->second.lastUse < b->second.lastUse;
+    });
+
+    std::size_t freed = 0;
+    for (auto it : unused) {
+        if (total - freed <= budgetBytes)
+            break;
+        freed += it->second.cpuBytes + it->second.gpuBytes;
+        entries.erase(it);
+    }
+    return freed;
+}
+
+std::size_t ResourceCache::getTotalBytes() const {
+    std::size_t total = 0;
+    for (const auto& entry : entries)
+        total += entry.second.cpuBytes + entry.second.gpuBytes;
+    return total;
+}
+
+std::vector<ResourceInfo> ResourceCache::getReport() const {
+    std::vector<ResourceInfo> report;
+    report.reserve(entries.size());
+    for (const auto& entry : entries) {
+        ResourceInfo info;
+        info.key = entry.first;
+        info.type = entry.second.type;
+        info.references = entry.second.resource.use_count() - 1;
+        info.cpuBytes = entry.second.cpuBytes;
+        info.gpuBytes = entry.second.gpuBytes;
+        report.push_back(info);
+    }
+    // Largest first, which is what a memory report is read for
+    std::sort(report.begin(), report.end(), [](const ResourceInfo& a, const ResourceInfo& b) {
+        return a.cpuBytes + a.gpuBytes > b.cpuBytes + b.gpuBytes;
+    });
+    return report;
+}
+
+void ResourceCache::printReport(std::ostream& out) const {
+    std::size_t cpuTotal = 0, gpuTotal = 0;
+    out << "Resources (" << entries.size() << " entries, " << fileReads << " file reads, " << packLoads << " pack loads):" << std::endl;
+    out << "  type     refs    CPU KiB    GPU KiB  key" << std::endl;
+    for (const ResourceInfo& info : getReport()) {
+        out << "  " << std::left << std::setw(8) << typeName(info.type) << std::right
+            << std::setw(5) << info.references
+            << std::setw(11) << info.cpuBytes / 1024
+            << std::setw(11) << info.gpuBytes / 1024 << "  " << info.key << std::endl;
+        cpuTotal += info.cpuBytes;
+        gpuTotal += info.gpuBytes;
+    }
+    out << "  total        " << std::setw(11) << cpuTotal / 1024 << std::setw(11) << gpuTotal / 1024 << std::endl;
+}
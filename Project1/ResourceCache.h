@@ -0,0 +1,91 @@
+#ifndef RESOURCECACHE_H
+#define RESOURCECACHE_H
+
+#include <SFML/Audio.hpp>
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "AssetPack.h"
+
+// Shared, read-only resources; the cache keeps one reference of its own
+typedef std::shared_ptr<const sf::Texture> TextureHandle;
+typedef std::shared_ptr<const sf::Font> FontHandle;
+typedef std::shared_ptr<const sf::SoundBuffer> SoundBufferHandle;
+
+enum class ResourceType {
+    Texture,
+    Font,
+    SoundBuffer
+};
+
+// One line of the memory report
+struct ResourceInfo {
+    std::string key;
+    ResourceType type;
+    long references;       // Handles held outside the cache
+    std::size_t cpuBytes;
+    std::size_t gpuBytes;  // Estimated
+};
+
+// Central owner of textures, fonts and sound buffers, keyed by path.
+// Each file is read at most once while its entry lives; callers get
+// reference-counted handles, and entries nobody else holds can be evicted,
+// least recently requested first, to fit a memory budget. Memory is
+// estimated per entry: textures as 4 bytes per texel on the GPU, fonts as
+// the file kept in memory for FreeType, sound buffers as their samples.
+// With a pack mounted, names found in it load from the mapped archive
+// instead of loose files; fonts then keep pointing into the mapping, which
+// is file-backed and so counts no private CPU memory.
+// Not thread-safe; use it from the render thread.
+class ResourceCache {
+public:
+    ResourceCache();
+
+    // Later loads look in the pack before the file system
+    void mountPack(std::shared_ptr<const AssetPack> pack) { this->pack = std::move(pack); }
+    const std::shared_ptr<const AssetPack>& getPack() const { return pack; }
+
+    // Null handle if the file cannot be loaded
+    TextureHandle getTexture(const std::string& file);
+    FontHandle getFont(const std::string& file);
+    SoundBufferHandle getSoundBuffer(const std::string& file);
+
+    // Track a texture created elsewhere (atlas pages, streamed uploads) under a key
+    TextureHandle addTexture(const std::string& key, std::shared_ptr<sf::Texture> texture);
+    // Null handle if the key is not cached as a texture
+    TextureHandle findTexture(const std::string& key);
+
+    // Evict unused entries until the total fits the budget; returns bytes freed
+    std::size_t evictUnused(std::size_t budgetBytes);
+
+    std::size_t getTotalBytes() const;
+    std::uint64_t getFileReads() const { return fileReads; }
+    std::uint64_t getPackLoads() const { return packLoads; }
+    std::vector<ResourceInfo> getReport() const;
+    void printReport(std::ostream& out) const;
+
+private:
+    struct Entry {
+        ResourceType type;
+        std::shared_ptr<const void> resource; // Shares the control block with the handles
+        std::size_t cpuBytes;
+        std::size_t gpuBytes;
+        std::uint64_t lastUse;
+    };
+
+    Entry* find(const std::string& key, ResourceType type);
+    void insert(const std::string& key, ResourceType type, std::shared_ptr<const void> resource,
+                std::size_t cpuBytes, std::size_t gpuBytes);
+
+    std::map<std::string, Entry> entries;
+    std::shared_ptr<const AssetPack> pack;
+    std::uint64_t useCounter;
+    std::uint64_t fileReads;
+    std::uint64_t packLoads;
+};
+
+#endif // RESOURCECACHE_H
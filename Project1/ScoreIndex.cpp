@@ -0,0 +1,196 @@
+#include "ScoreIndex.h"
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+const ScoreIndex::Node ScoreIndex::NONE;
+
+ScoreIndex::ScoreIndex()
+    : root(NONE),
+      random(0x5EEDu) {
+}
+
+void ScoreIndex::clear() {
+    scores.clear();
+    sequences.clear();
+    names.clear();
+    left.clear();
+    right.clear();
+    sizes.clear();
+    priorities.clear();
+    root = NONE;
+}
+
+void ScoreIndex::reserve(std::size_t entries) {
+    scores.reserve(entries);
+    sequences.reserve(entries);
+    names.reserve(entries);
+    left.reserve(entries);
+    right.reserve(entries);
+    sizes.reserve(entries);
+    priorities.reserve(entries);
+}
+
+bool ScoreIndex::assignSorted(std::vector<int> sortedScores, std::vector<std::uint64_t> sortedSequences, std::vector<Name> sortedNames) {
+    std::size_t count = sortedScores.size();
+    for (std::size_t i = 1; i < count; ++i) {
+        if (!ranksAbove(sortedScores[i - 1], sortedSequences[i - 1], sortedScores[i], sortedSequences[i]))
+            return false;
+    }
+
+    clear();
+    scores = std::move(sortedScores);
+    sequences = std::move(sortedSequences);
+    names = std::move(sortedNames);
+    left.assign(count, NONE);
+    right.assign(count, NONE);
+    sizes.assign(count, 1);
+    priorities.assign(count, 0);
+    if (count == 0)
+        return true;
+    root = buildBalanced(0, static_cast<std::uint32_t>(count));
+
+    // Hand out random priorities, largest first in breadth-first order, so the
+    // tree is a valid treap and later inserts balance as if it had been built one by one
+    std::vector<std::uint32_t> randomPriorities(count);
+    for (std::uint32_t& priority : randomPriorities)
+        priority = random.next();
+    std::sort(randomPriorities.begin(), randomPriorities.end(), std::greater<std::uint32_t>());
+    std::vector<Node> queue;
+    queue.reserve(count);
+    queue.push_back(root);
+    for (std::size_t i = 0; i < queue.size(); ++i) {
+        Node node = queue[i];
+        priorities[node] = randomPriorities[i];
+        if (left[node] != NONE)
+            queue.push_back(left[node]);
+        if (right[node] != NONE)
+            queue.push_back(right[node]);
+    }
+    return true;
+}
+
+ScoreIndex::Node ScoreIndex::buildBalanced(std::uint32_t first, std::uint32_t last) {
+    if (first == last)
+        return NONE;
+    Node middle = first + (last - first) / 2;
+    left[middle] = buildBalanced(first, middle);
+    right[middle] = buildBalanced(middle + 1, last);
+    update(middle);
+    return middle;
+}
+
+std::uint64_t ScoreIndex::insert(int score, std::uint64_t sequence, const Name& name) {
+    Node node = static_cast<Node>(scores.size());
+    scores.push_back(score);
+    sequences.push_back(sequence);
+    names.push_back(name);
+    left.push_back(NONE);
+    right.push_back(NONE);
+    sizes.push_back(1);
+    priorities.push_back(random.next());
+    root = insertAt(root, node);
+    return rankOf(score, sequence);
+}
+
+ScoreIndex::Node ScoreIndex::insertAt(Node subtree, Node node) {
+    if (subtree == NONE)
+        return node;
+    // The new node takes over this subtree if it wins the heap order
+    if (priorities[node] > priorities[subtree]) {
+        split(subtree, node, left[node], right[node]);
+        update(node);
+        return node;
+    }
+    if (ranksAbove(node, subtree))
+        left[subtree] = insertAt(left[subtree], node);
+    else
+        right[subtree] = insertAt(right[subtree], node);
+    update(subtree);
+    return subtree;
+}
+
+void ScoreIndex::split(Node subtree, Node node, Node& lower, Node& upper) {
+    // lower gets the entries ranking above node, upper the rest
+    if (subtree == NONE) {
+        lower = NONE;
+        upper = NONE;
+        return;
+    }
+    if (ranksAbove(subtree, node)) {
+        split(right[subtree], node, right[subtree], upper);
+        lower = subtree;
+    }
+    else {
+        split(left[subtree], node, lower, left[subtree]);
+        upper = subtree;
+    }
+    update(subtree);
+}
+
+std::uint64_t ScoreIndex::rankOf(int score, std::uint64_t sequence) const {
+    std::uint64_t rank = 0;
+    for (Node node = root; node != NONE;) {
+        if (ranksAbove(scores[node], sequences[node], score, sequence)) {
+            rank += sizeOf(left[node]) + 1;
+            node = right[node];
+        }
+        else {
+            node = left[node];
+        }
+    }
+    return rank;
+}
+
+ScoreIndex::Node ScoreIndex::at(std::uint64_t rank) const {
+    if (rank >= size())
+        return NONE;
+    Node node = root;
+    for (;;) {
+        std::uint64_t leftSize = sizeOf(left[node]);
+        if (rank < leftSize) {
+            node = left[node];
+        }
+        else if (rank == leftSize) {
+            return node;
+        }
+        else {
+            rank -= leftSize + 1;
+            node = right[node];
+        }
+    }
+}
+
+void ScoreIndex::page(std::uint64_t first, std::size_t count, std::vector<Node>& out) const {
+    out.clear();
+    if (first >= size() || count == 0)
+        return;
+
+    // Descend to the first entry keeping the path, then walk in order from there
+    std::vector<Node> path;
+    Node node = root;
+    std::uint64_t rank = first;
+    while (node != NONE) {
+        std::uint64_t leftSize = sizeOf(left[node]);
+        if (rank < leftSize) {
+            path.push_back(node);
+            node = left[node];
+        }
+        else if (rank == leftSize) {
+            path.push_back(node);
+            break;
+        }
+        else {
+            rank -= leftSize + 1;
+            node = right[node];
+        }
+    }
+
+    while (!path.empty() && out.size() < count) {
+        node = path.back();
+        path.pop_back();
+        out.push_back(node);
+        for (Node next = right[node]; next != NONE; next = left[next])
+            path.push_back(next);
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef SCOREINDEX_H
+#define SCOREINDEX_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "GameSim.h"
+
+const std::size_t LEADERBOARD_NAME_LENGTH = 16; // Bytes, zero-padded, not necessarily terminated
+
+// Order-statistic treap over leaderboard entries.
+// Entries rank by score, highest first, and earlier runs win ties. Every
+// node knows its subtree size, so insert, rank lookup and fetching the
+// entry at a rank are all O(log n). Nodes live in parallel arrays indexed
+// by 32-bit links instead of separate allocations, which keeps tens of
+// millions of entries at about 44 bytes each. Not thread-safe.
+class ScoreIndex {
+public:
+    typedef std::uint32_t Node;
+    typedef std::array<char, LEADERBOARD_NAME_LENGTH> Name;
+    static const Node NONE = 0xFFFFFFFFu;
+
+    ScoreIndex();
+
+    void clear();
+    void reserve(std::size_t entries);
+    std::size_t size() const { return scores.size(); }
+
+    // Replace the contents with entries already in rank order, in O(n log n)
+    // but without any rotations; false if they are not in rank order
+    bool assignSorted(std::vector<int> sortedScores, std::vector<std::uint64_t> sortedSequences, std::vector<Name> sortedNames);
+
+    // Returns the 0-based rank the entry was placed at
+    std::uint64_t insert(int score, std::uint64_t sequence, const Name& name);
+
+    // Entries that rank above this score and sequence
+    std::uint64_t rankOf(int score, std::uint64_t sequence) const;
+    // Entry at a 0-based rank, NONE if out of range
+    Node at(std::uint64_t rank) const;
+    // Up to count entries starting at a rank, in rank order
+    void page(std::uint64_t first, std::size_t count, std::vector<Node>& out) const;
+
+    // Rank order: higher scores first, then earlier runs
+    static bool ranksAbove(int scoreA, std::uint64_t sequenceA, int scoreB, std::uint64_t sequenceB) {
+        return scoreA > scoreB || (scoreA == scoreB && sequenceA < sequenceB);
+    }
+
+    int score(Node node) const { return scores[node]; }
+    std::uint64_t sequence(Node node) const { return sequences[node]; }
+    const Name& name(Node node) const { return names[node]; }
+
+private:
+    bool ranksAbove(Node a, Node b) const { return ranksAbove(scores[a], sequences[a], scores[b], sequences[b]); }
+    std::uint32_t sizeOf(Node node) const { return node == NONE ? 0 : sizes[node]; }
+    void update(Node node) { sizes[node] = 1 + sizeOf(left[node]) + sizeOf(right[node]); }
+
+    Node insertAt(Node root, Node node);
+    void split(Node root, Node node, Node& lower, Node& upper);
+    Node buildBalanced(std::uint32_t first, std::uint32_t last);
+
+    std::vector<int> scores;
+    std::vector<std::uint64_t> sequences;
+    std::vector<Name> names;
+    std::vector<Node> left;
+    std::vector<Node> right;
+    std::vector<std::uint32_t> sizes;
+    std::vector<std::uint32_t> priorities;
+    Node root;
+    SimRandom random;
+};
+
+#endif // SCOREINDEX_H
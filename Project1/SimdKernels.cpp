@@ -0,0 +1,192 @@
+#include "SimdKernels.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SIMD_TARGET_AVX2
+#define SIMD_POPCOUNT(x) static_cast<std::size_t>(__popcnt(x))
+#else
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#define SIMD_POPCOUNT(x) static_cast<std::size_t>(__builtin_popcount(x))
+#endif
+#else
+#define SIMD_X86 0
+#endif
+
+namespace {
+
+// Scalar reference path; the vector paths must match it bit for bit
+
+void integrateScalar(float* pos, float* prevPos, std::size_t begin, std::size_t count, float step) {
+    for (std::size_t i = begin; i < count; ++i) {
+        prevPos[i] = pos[i];
+        pos[i] += step;
+    }
+}
+
+std::size_t testBoxesScalar(const float* left, const float* top, const float* right, const float* bottom, std::size_t begin, std::size_t count,
+                            float queryLeft, float queryTop, float queryRight, float queryBottom, std::uint8_t* hitMask) {
+    std::size_t hits = 0;
+    for (std::size_t i = begin; i < count; ++i) {
+        if (i % 8 == 0)
+            hitMask[i / 8] = 0;
+        if (left[i] < queryRight && queryLeft < right[i] && top[i] < queryBottom && queryTop < bottom[i]) {
+            hitMask[i / 8] |= static_cast<std::uint8_t>(1u << (i % 8));
+            ++hits;
+        }
+    }
+    return hits;
+}
+
+#if SIMD_X86
+
+void integrateSse2(float* pos, float* prevPos, std::size_t count, float step) {
+    __m128 stepVec = _mm_set1_ps(step);
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 p = _mm_loadu_ps(pos + i);
+        _mm_storeu_ps(prevPos + i, p);
+        _mm_storeu_ps(pos + i, _mm_add_ps(p, stepVec));
+    }
+    integrateScalar(pos, prevPos, i, count, step);
+}
+
+std::size_t testBoxesSse2(const float* left, const float* top, const float* right, const float* bottom, std::size_t count,
+                          float queryLeft, float queryTop, float queryRight, float queryBottom, std::uint8_t* hitMask) {
+    __m128 qLeft = _mm_set1_ps(queryLeft);
+    __m128 qTop = _mm_set1_ps(queryTop);
+    __m128 qRight = _mm_set1_ps(queryRight);
+    __m128 qBottom = _mm_set1_ps(queryBottom);
+    std::size_t hits = 0;
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int bits = 0;
+        for (int half = 0; half < 2; ++half) {
+            std::size_t j = i + half * 4;
+            __m128 overlap = _mm_and_ps(
+                _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(left + j), qRight), _mm_cmplt_ps(qLeft, _mm_loadu_ps(right + j))),
+                _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(top + j), qBottom), _mm_cmplt_ps(qTop, _mm_loadu_ps(bottom + j))));
+            bits |= _mm_movemask_ps(overlap) << (half * 4);
+        }
+        hitMask[i / 8] = static_cast<std::uint8_t>(bits);
+        hits += SIMD_POPCOUNT(static_cast<unsigned>(bits));
+    }
+    return hits + testBoxesScalar(left, top, right, bottom, i, count, queryLeft, queryTop, queryRight, queryBottom, hitMask);
+}
+
+SIMD_TARGET_AVX2 void integrateAvx2(float* pos, float* prevPos, std::size_t count, float step) {
+    __m256 stepVec = _mm256_set1_ps(step);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 p = _mm256_loadu_ps(pos + i);
+        _mm256_storeu_ps(prevPos + i, p);
+        _mm256_storeu_ps(pos + i, _mm256_add_ps(p, stepVec));
+    }
+    integrateScalar(pos, prevPos, i, count, step);
+}
+
+SIMD_TARGET_AVX2 std::size_t testBoxesAvx2(const float* left, const float* top, const float* right, const float* bottom, std::size_t count,
+                                           float queryLeft, float queryTop, float queryRight, float queryBottom, std::uint8_t* hitMask) {
+    __m256 qLeft = _mm256_set1_ps(queryLeft);
+    __m256 qTop = _mm256_set1_ps(queryTop);
+    __m256 qRight = _mm256_set1_ps(queryRight);
+    __m256 qBottom = _mm256_set1_ps(queryBottom);
+    std::size_t hits = 0;
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // Ordered, non-signalling compares give the same result as the scalar '<' (false on NaN)
+        __m256 overlap = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(left + i), qRight, _CMP_LT_OQ), _mm256_cmp_ps(qLeft, _mm256_loadu_ps(right + i), _CMP_LT_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(top + i), qBottom, _CMP_LT_OQ), _mm256_cmp_ps(qTop, _mm256_loadu_ps(bottom + i), _CMP_LT_OQ)));
+        int bits = _mm256_movemask_ps(overlap);
+        hitMask[i / 8] = static_cast<std::uint8_t>(bits);
+        hits += SIMD_POPCOUNT(static_cast<unsigned>(bits));
+    }
+    return hits + testBoxesScalar(left, top, right, bottom, i, count, queryLeft, queryTop, queryRight, queryBottom, hitMask);
+}
+
+#endif // SIMD_X86
+
+SimdLevel& currentLevel() {
+    static SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+} // namespace
+
+SimdLevel detectSimdLevel() {
+#if SIMD_X86
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] >= 7) {
+        __cpuid(info, 1);
+        bool osSavesAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 0x6) == 0x6;
+        __cpuidex(info, 7, 0);
+        if (osSavesAvx && (info[1] & (1 << 5)))
+            return SimdLevel::Avx2;
+    }
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return SimdLevel::Avx2;
+#endif
+    // SSE2 is part of the x86-64 baseline
+    return SimdLevel::Sse2;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+SimdLevel activeSimdLevel() {
+    return currentLevel();
+}
+
+void setSimdLevel(SimdLevel level) {
+    // Never run above what the CPU supports
+    SimdLevel supported = detectSimdLevel();
+    currentLevel() = static_cast<int>(level) <= static_cast<int>(supported) ? level : supported;
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Avx2:
+        return "avx2";
+    case SimdLevel::Sse2:
+        return "sse2";
+    default:
+        return "scalar";
+    }
+}
+
+void integratePositions(float* pos, float* prevPos, std::size_t count, float step) {
+    switch (currentLevel()) {
+#if SIMD_X86
+    case SimdLevel::Avx2:
+        integrateAvx2(pos, prevPos, count, step);
+        return;
+    case SimdLevel::Sse2:
+        integrateSse2(pos, prevPos, count, step);
+        return;
+#endif
+    default:
+        integrateScalar(pos, prevPos, 0, count, step);
+        return;
+    }
+}
+
+std::size_t testBoxes(const float* left, const float* top, const float* right, const float* bottom, std::size_t count,
+                      float queryLeft, float queryTop, float queryRight, float queryBottom, std::uint8_t* hitMask) {
+    switch (currentLevel()) {
+#if SIMD_X86
+    case SimdLevel::Avx2:
+        return testBoxesAvx2(left, top, right, bottom, count, queryLeft, queryTop, queryRight, queryBottom, hitMask);
+    case SimdLevel::Sse2:
+        return testBoxesSse2(left, top, right, bottom, count, queryLeft, queryTop, queryRight, queryBottom, hitMask);
+#endif
+    default:
+        return testBoxesScalar(left, top, right, bottom, 0, count, queryLeft, queryTop, queryRight, queryBottom, hitMask);
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef SIMDKERNELS_H
+#define SIMDKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Instruction sets the batch kernels can run on
+enum class SimdLevel {
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+// Best level supported by this CPU (and OS, for AVX state)
+SimdLevel detectSimdLevel();
+
+// Level used by the kernels below; defaults to detectSimdLevel().
+// Forcing a lower level lets benchmarks compare paths.
+SimdLevel activeSimdLevel();
+void setSimdLevel(SimdLevel level);
+const char* simdLevelName(SimdLevel level);
+
+// prevPos[i] = pos[i]; pos[i] += step for every item
+void integratePositions(float* pos, float* prevPos, std::size_t count, float step);
+
+// Tests count boxes against one query box with the sf::FloatRect::intersects rule.
+// Writes one bit per box, LSB first: hitMask must hold (count + 7) / 8 bytes.
+// Returns the number of hits.
+std::size_t testBoxes(const float* left, const float* top, const float* right, const float* bottom, std::size_t count,
+                      float queryLeft, float queryTop, float queryRight, float queryBottom, std::uint8_t* hitMask);
+
+#endif // SIMDKERNELS_H
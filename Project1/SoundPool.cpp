@@ -0,0 +1,106 @@
+#include "SoundPool.h"
+#include <iostream>
+#include "Profiler.h"
+
+const std::size_t SoundPool::MAX_VOICES;
+
+SoundPool::SoundPool(std::size_t maxActive)
+    : maxActive(maxActive),
+      activeVoices(0),
+      playCounter(0),
+      stolenVoices(0),
+      droppedSounds(0) {
+    voices.reserve(MAX_VOICES);
+}
+
+SoundEffectId SoundPool::addEffect(SoundBufferHandle buffer, int priority, std::size_t voiceCount) {
+    if (!buffer || voiceCount == 0)
+        return NO_SOUND_EFFECT;
+    if (voices.size() + voiceCount > MAX_VOICES) {
+        std::cerr << "Sound pool is limited to " << MAX_VOICES << " voices" << std::endl;
+        return NO_SOUND_EFFECT;
+    }
+
+    SoundEffectId id = effects.size();
+    effects.push_back(Effect{ buffer, priority, voices.size(), voiceCount });
+    for (std::size_t i = 0; i < voiceCount; ++i) {
+        voices.push_back(Voice{ sf::Sound(), id, 0, false });
+        voices.back().sound.setBuffer(*buffer);
+    }
+    return id;
+}
+
+void SoundPool::stop(Voice& voice) {
+    voice.sound.stop();
+    voice.playing = false;
+    --activeVoices;
+}
+
+bool SoundPool::play(SoundEffectId id, float volume, float pitch) {
+    if (id >= effects.size())
+        return false;
+    const Effect& effect = effects[id];
+
+    // A free voice of this effect, or else its oldest one
+    Voice* target = nullptr;
+    for (std::size_t i = effect.firstVoice; i < effect.firstVoice + effect.voiceCount; ++i) {
+        Voice& voice = voices[i];
+        if (!voice.playing) {
+            target = &voice;
+            break;
+        }
+        if (!target || voice.startedAt < target->startedAt)
+            target = &voice;
+    }
+
+    if (target->playing) {
+        stop(*target);
+        ++stolenVoices;
+        PROFILE_COUNT(ProfileCounter::VoicesStolen, 1);
+    }
+    else if (activeVoices >= maxActive) {
+        // Make room by stopping the least important voice playing anywhere
+        Voice* victim = nullptr;
+        for (Voice& voice : voices) {
+            if (!voice.playing)
+                continue;
+            int priority = effects[voice.effect].priority;
+            int victimPriority = victim ? effects[victim->effect].priority : 0;
+            if (!victim || priority < victimPriority || (priority == victimPriority && voice.startedAt < victim->startedAt))
+                victim = &voice;
+        }
+        if (!victim || effects[victim->effect].priority > effect.priority) {
+            ++droppedSounds;
+            PROFILE_COUNT(ProfileCounter::VoicesDropped, 1);
+            return false;
+        }
+        stop(*victim);
+        ++stolenVoices;
+        PROFILE_COUNT(ProfileCounter::VoicesStolen, 1);
+    }
+
+    target->sound.setVolume(volume);
+    target->sound.setPitch(pitch);
+    target->sound.play();
+    target->playing = true;
+    target->startedAt = ++playCounter;
+    ++activeVoices;
+    return true;
+}
+
+void SoundPool::stopAll() {
+    for (Voice& voice : voices) {
+        if (voice.playing)
+            stop(voice);
+    }
+}
+
+void SoundPool::update() {
+    for (Voice& voice : voices) {
+        if (voice.playing && voice.sound.getStatus() != sf::Sound::Playing) {
+            voice.playing = false;
+            --activeVoices;
+        }
+    }
+    PROFILE_SET_COUNT(ProfileCounter::VoicesActive, static_cast<std::uint32_t>(activeVoices));
+}
@@ -0,0 +1,73 @@
+#ifndef SOUNDPOOL_H
+#define SOUNDPOOL_H
+
+#include <SFML/Audio.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ResourceCache.h"
+
+typedef std::size_t SoundEffectId;
+const SoundEffectId NO_SOUND_EFFECT = static_cast<SoundEffectId>(-1);
+
+// Short sound effects played from a fixed set of sf::Sound voices.
+// Each effect gets its voices when it is added, already bound to its buffer,
+// so playing never creates an OpenAL source and never touches the buffer's
+// list of attached sounds (which allocates). At most maxActive voices play at
+// once: past that a new sound stops the least important voice playing, lowest
+// priority then oldest, unless that voice is more important, in which case
+// the new sound is dropped. An effect whose own voices are all busy restarts
+// its oldest one. Use from the main thread only.
+class SoundPool {
+public:
+    // Every voice is an OpenAL source for the life of the pool; OpenAL Soft
+    // allows 256 for the whole process, so stay far below that
+    static const std::size_t MAX_VOICES = 32;
+
+    explicit SoundPool(std::size_t maxActive = 12);
+    SoundPool(const SoundPool&) = delete;
+    SoundPool& operator=(const SoundPool&) = delete;
+
+    // Load time only; NO_SOUND_EFFECT for a null buffer or past MAX_VOICES
+    SoundEffectId addEffect(SoundBufferHandle buffer, int priority, std::size_t voices);
+    // False if the sound was dropped
+    bool play(SoundEffectId effect, float volume = 100.0f, float pitch = 1.0f);
+    void stopAll();
+
+    // Frees voices that have finished and reports the counters to the profiler; once per frame
+    void update();
+
+    std::size_t getActiveVoices() const { return activeVoices; }
+    std::uint64_t getStolenVoices() const { return stolenVoices; }
+    std::uint64_t getDroppedSounds() const { return droppedSounds; }
+
+private:
+    struct Effect {
+        SoundBufferHandle buffer;
+        int priority;
+        std::size_t firstVoice;
+        std::size_t voiceCount;
+    };
+
+    struct Voice {
+        sf::Sound sound;
+        SoundEffectId effect;
+        std::uint64_t startedAt;
+        bool playing;
+    };
+
+    void stop(Voice& voice);
+
+    std::size_t maxActive;
+    std::size_t activeVoices;
+    std::uint64_t playCounter;
+    std::uint64_t stolenVoices;
+    std::uint64_t droppedSounds;
+
+    // Declared before the voices so the buffers outlive the sounds playing them
+    std::vector<Effect> effects;
+    // Reserved up front: a bound sf::Sound must never move
+    std::vector<Voice> voices;
+};
+
+#endif // SOUNDPOOL_H
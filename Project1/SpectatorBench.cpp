@@ -0,0 +1,141 @@
+#include "SpectatorBench.h"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "SpectatorClient.h"
+#include "SpectatorRelay.h"
+
+namespace {
+
+// Viewer connections are shared out over at most this many threads
+const int MAX_VIEWER_THREADS = 8;
+const int BENCH_PLAYERS = 8;
+// One viewer in STALLED_VIEWER_RATIO never reads its socket
+const int STALLED_VIEWER_RATIO = 100;
+
+struct ViewerResult {
+    int connected;
+    std::uint64_t frames;
+    std::uint64_t undecodable;
+};
+
+void runViewerThread(unsigned short port, int first, int count, const std::atomic<bool>& done, ViewerResult& result) {
+    std::vector<std::unique_ptr<SpectatorClient>> clients;
+    std::vector<bool> stalled;
+    for (int i = 0; i < count; ++i) {
+        std::unique_ptr<SpectatorClient> client(new SpectatorClient());
+        if (!client->connect(sf::IpAddress::LocalHost, port))
+            continue;
+        clients.push_back(std::move(client));
+        stalled.push_back((first + i) % STALLED_VIEWER_RATIO == STALLED_VIEWER_RATIO - 1);
+    }
+    result.connected = static_cast<int>(clients.size());
+
+    while (!done) {
+        for (std::size_t i = 0; i < clients.size(); ++i) {
+            if (!stalled[i])
+                clients[i]->update();
+        }
+        sf::sleep(sf::milliseconds(2));
+    }
+
+    result.frames = 0;
+    result.undecodable = 0;
+    for (std::size_t i = 0; i < clients.size(); ++i) {
+        if (stalled[i])
+            continue;
+        result.frames += clients[i]->getStats().frames;
+        result.undecodable += clients[i]->getStats().undecodable;
+    }
+}
+
+// Random walk for every player, like the multiplayer bots
+void stepGame(GameSim& sim, SimRandom& random, std::vector<InputState>& inputs) {
+    for (InputState& input : inputs) {
+        if (random.range(30) == 0) {
+            int direction = random.range(3);
+            input = InputState{ direction == 0, direction == 1 };
+        }
+    }
+    sim.step(SIM_TICK, inputs.data());
+    if (sim.isGameOver())
+        sim.reset();
+}
+
+} // namespace
+
+int runSpectatorBench(unsigned short port, int viewers, float seconds) {
+    SpectatorRelay relay;
+    if (!relay.listen(port))
+        return 1;
+    std::thread relayThread([&relay] { relay.run(); });
+
+    // Viewers connect before the game starts so every one of them is measured
+    std::atomic<bool> done(false);
+    int threadCount = std::max(1, std::min(viewers, MAX_VIEWER_THREADS));
+    std::vector<ViewerResult> results(threadCount, ViewerResult{ 0, 0, 0 });
+    std::vector<std::thread> threads;
+    for (int i = 0, first = 0; i < threadCount; ++i) {
+        int threadViewers = viewers / threadCount + (i < viewers % threadCount ? 1 : 0);
+        threads.emplace_back(runViewerThread, port, first, threadViewers, std::cref(done), std::ref(results[i]));
+        first += threadViewers;
+    }
+    sf::Clock connectClock;
+    while (relay.getStats().viewers < viewers && connectClock.getElapsedTime() < sf::seconds(10.0f))
+        sf::sleep(sf::milliseconds(10));
+    int connected = relay.getStats().viewers;
+
+    GameSimConfig config = GameSim::defaultConfig();
+    config.playerCount = BENCH_PLAYERS;
+    GameSim sim(config);
+    SimRandom random(1);
+    std::vector<InputState> inputs(BENCH_PLAYERS, InputState{ false, false });
+    NetSnapshot snapshot;
+    relay.resetStats();
+
+    sf::Clock clock;
+    sf::Time next = sf::Time::Zero;
+    for (std::uint32_t tick = 1; clock.getElapsedTime() < sf::seconds(seconds); ++tick) {
+        stepGame(sim, random, inputs);
+        if (tick % NET_TICKS_PER_SNAPSHOT == 0) {
+            captureSnapshot(sim, tick, snapshot);
+            relay.publish(snapshot);
+        }
+        next += sf::seconds(SIM_TICK);
+        sf::Time wait = next - clock.getElapsedTime();
+        if (wait > sf::Time::Zero)
+            sf::sleep(wait);
+    }
+    float elapsed = clock.getElapsedTime().asSeconds();
+    // Give the workers a moment to write the last frames
+    sf::sleep(sf::milliseconds(100));
+    SpectatorRelay::Stats stats = relay.getStats();
+
+    done = true;
+    for (std::thread& thread : threads)
+        thread.join();
+    relay.stop();
+    relayThread.join();
+
+    std::uint64_t frames = 0;
+    std::uint64_t undecodable = 0;
+    for (const ViewerResult& result : results) {
+        frames += result.frames;
+        undecodable += result.undecodable;
+    }
+    int reading = connected - connected / STALLED_VIEWER_RATIO;
+    double frameCount = std::max<std::uint64_t>(1, stats.framesPublished);
+
+    std::cout << connected << " of " << viewers << " viewers, " << stats.framesPublished << " frames (" << stats.keyframes << " keyframes) in " << elapsed << " s" << std::endl;
+    std::cout << "Encoded once: " << stats.bytesEncoded / frameCount << " bytes and " << stats.encodeSeconds / frameCount * 1e6 << " us per frame" << std::endl;
+    std::cout << "Sent " << stats.bytesSent / elapsed / std::max(1, connected) << " bytes/s per viewer, " << stats.bytesSent / elapsed / 1e6 << " MB/s in total" << std::endl;
+    std::cout << "Relay workers: " << stats.workerSeconds / elapsed * 100.0 << "% of a core, "
+              << stats.workerSeconds / elapsed / std::max(1, connected) * 1e6 << " us per viewer per second, "
+              << stats.workerSeconds / frameCount / std::max(1, connected) * 1e6 << " us per viewer per frame" << std::endl;
+    std::cout << "Slow viewers dropped to keyframes " << stats.slowViewerDrops << " times, " << stats.framesSkipped << " frames skipped" << std::endl;
+    std::cout << "Reading viewers received " << frames / std::max(1, reading) << " frames each, " << undecodable << " undecodable" << std::endl;
+    return connected == viewers && undecodable == 0 && frames > 0 ? 0 : 1;
+}
@@ -0,0 +1,12 @@
+#ifndef SPECTATORBENCH_H
+#define SPECTATORBENCH_H
+
+// Loopback test of the spectator relay.
+// Runs an eight-player game with random input, publishes it through a
+// SpectatorRelay on the given port and connects the given number of viewers
+// from a few threads; one in a hundred viewers never reads, to exercise the
+// slow-consumer path. Prints relay CPU time per viewer and bandwidth;
+// returns the process exit code.
+int runSpectatorBench(unsigned short port, int viewers, float seconds);
+
+#endif // SPECTATORBENCH_H
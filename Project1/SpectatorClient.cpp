@@ -0,0 +1,57 @@
+#include "SpectatorClient.h"
+#include <iostream>
+
+namespace {
+
+// Bytes before the encoded snapshot: type, tick, baseline tick
+const std::size_t FRAME_HEADER_SIZE = 1 + 4 + 4;
+
+} // namespace
+
+SpectatorClient::SpectatorClient() {
+    snapshot.tick = NET_NO_BASELINE;
+    stats = Stats{ 0, 0, 0, 0 };
+}
+
+bool SpectatorClient::connect(const sf::IpAddress& host, unsigned short port, sf::Time timeout) {
+    if (socket.connect(host, port, timeout) != sf::Socket::Done) {
+        std::cerr << "Failed to connect to spectator relay " << host << ":" << port << std::endl;
+        return false;
+    }
+    socket.setBlocking(false);
+    return true;
+}
+
+bool SpectatorClient::update() {
+    for (;;) {
+        sf::Packet packet;
+        sf::Socket::Status status = socket.receive(packet);
+        if (status == sf::Socket::NotReady || status == sf::Socket::Partial)
+            return true;
+        if (status != sf::Socket::Done)
+            return false;
+
+        sf::Uint8 type;
+        sf::Uint32 tick;
+        sf::Uint32 baselineTick;
+        if (!(packet >> type >> tick >> baselineTick) || type != static_cast<sf::Uint8>(NetMessage::Snapshot))
+            return false;
+        stats.bytesReceived += packet.getDataSize() + 4;
+
+        bool keyframe = baselineTick == NET_NO_BASELINE;
+        if (!keyframe && baselineTick != snapshot.tick) {
+            ++stats.undecodable;
+            continue;
+        }
+        const std::uint8_t* data = static_cast<const std::uint8_t*>(packet.getData()) + FRAME_HEADER_SIZE;
+        if (!decodeSnapshot(data, packet.getDataSize() - FRAME_HEADER_SIZE, keyframe ? nullptr : &snapshot, decoding)) {
+            ++stats.undecodable;
+            continue;
+        }
+        decoding.tick = tick;
+        std::swap(snapshot, decoding);
+        ++stats.frames;
+        if (keyframe)
+            ++stats.keyframes;
+    }
+}
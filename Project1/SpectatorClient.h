@@ -0,0 +1,39 @@
+#ifndef SPECTATORCLIENT_H
+#define SPECTATORCLIENT_H
+
+#include <SFML/Network.hpp>
+#include <cstdint>
+#include "NetProtocol.h"
+#include "NetSnapshot.h"
+
+// Watches a SpectatorRelay: receives frames without blocking and keeps the
+// newest snapshot. Each delta is decoded against the frame before it, so the
+// client only ever holds one snapshot; after a gap it waits for a keyframe.
+class SpectatorClient {
+public:
+    struct Stats {
+        std::uint64_t bytesReceived;
+        std::uint64_t frames;
+        std::uint64_t keyframes;
+        std::uint64_t undecodable; // Deltas whose baseline was never received
+    };
+
+    SpectatorClient();
+
+    bool connect(const sf::IpAddress& host, unsigned short port = SPECTATOR_PORT, sf::Time timeout = sf::seconds(3.0f));
+    // Reads every frame that has arrived; false once the relay has gone
+    bool update();
+
+    // Nothing to show until the first keyframe
+    bool hasSnapshot() const { return snapshot.tick != NET_NO_BASELINE; }
+    const NetSnapshot& getSnapshot() const { return snapshot; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    sf::TcpSocket socket;
+    NetSnapshot snapshot;
+    NetSnapshot decoding;
+    Stats stats;
+};
+
+#endif // SPECTATORCLIENT_H
@@ -0,0 +1,319 @@
+#include "SpectatorRelay.h"
+#include <deque>
+#include <iostream>
+
+namespace {
+
+// How long a worker sleeps when no frame arrives; shorter while a viewer has a backlog
+const std::chrono::milliseconds WORKER_IDLE_WAIT(50);
+const std::chrono::milliseconds WORKER_BACKLOG_WAIT(2);
+// How long the accept loop waits before checking whether it should stop
+const sf::Time ACCEPT_POLL_INTERVAL = sf::milliseconds(100);
+// A selector wait of zero would block forever
+const sf::Time DISCONNECT_POLL = sf::microseconds(1);
+
+void putUint32(std::vector<std::uint8_t>& out, std::size_t offset, std::uint32_t value) {
+    // Network byte order, as sf::Packet reads it
+    out[offset] = static_cast<std::uint8_t>(value >> 24);
+    out[offset + 1] = static_cast<std::uint8_t>(value >> 16);
+    out[offset + 2] = static_cast<std::uint8_t>(value >> 8);
+    out[offset + 3] = static_cast<std::uint8_t>(value);
+}
+
+} // namespace
+
+// One thread, one selector and up to VIEWERS_PER_SELECTOR viewers
+class SpectatorRelay::Worker {
+public:
+    explicit Worker(SpectatorRelay& relay)
+        : relay(relay),
+          viewerCount(0),
+          stopping(false) {
+        thread = std::thread(&Worker::loop, this);
+    }
+
+    ~Worker() {
+        {
+            std::lock_guard<std::mutex> lock(inboxMutex);
+            stopping = true;
+        }
+        inboxChanged.notify_one();
+        thread.join();
+    }
+
+    // Both called from other threads; the worker picks them up on its next pass
+    void add(std::unique_ptr<sf::TcpSocket> socket) {
+        ++viewerCount;
+        {
+            std::lock_guard<std::mutex> lock(inboxMutex);
+            newSockets.push_back(std::move(socket));
+        }
+        inboxChanged.notify_one();
+    }
+
+    void push(const SharedSpectatorFrame& frame) {
+        {
+            std::lock_guard<std::mutex> lock(inboxMutex);
+            newFrames.push_back(frame);
+        }
+        inboxChanged.notify_one();
+    }
+
+    std::size_t getViewerCount() const { return viewerCount; }
+
+private:
+    struct Viewer {
+        std::unique_ptr<sf::TcpSocket> socket;
+        std::deque<SharedSpectatorFrame> queue;
+        std::size_t sentOfFront; // Bytes of the front frame already written
+        std::uint32_t lastTick; // Tick of the last frame queued, the baseline of the next delta
+        bool keyframesOnly;
+        bool closed;
+    };
+
+    void loop() {
+        std::vector<std::unique_ptr<sf::TcpSocket>> sockets;
+        std::vector<SharedSpectatorFrame> frames;
+        bool backlog = false;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(inboxMutex);
+                inboxChanged.wait_for(lock, backlog ? WORKER_BACKLOG_WAIT : WORKER_IDLE_WAIT,
+                    [this] { return stopping || !newFrames.empty() || !newSockets.empty(); });
+                if (stopping)
+                    return;
+                sockets.swap(newSockets);
+                frames.swap(newFrames);
+            }
+
+            sf::Clock busy;
+            for (std::unique_ptr<sf::TcpSocket>& socket : sockets)
+                addViewer(std::move(socket));
+            sockets.clear();
+            for (const SharedSpectatorFrame& frame : frames) {
+                for (std::unique_ptr<Viewer>& viewer : viewers)
+                    enqueue(*viewer, frame);
+            }
+            frames.clear();
+
+            backlog = false;
+            for (std::unique_ptr<Viewer>& viewer : viewers) {
+                flush(*viewer);
+                backlog = backlog || !viewer->queue.empty();
+            }
+            pollDisconnects();
+            removeClosedViewers();
+            relay.workerMicroseconds += busy.getElapsedTime().asMicroseconds();
+        }
+    }
+
+    void addViewer(std::unique_ptr<sf::TcpSocket> socket) {
+        socket->setBlocking(false);
+        selector.add(*socket);
+        // Nothing is decodable before a keyframe
+        viewers.push_back(std::unique_ptr<Viewer>(new Viewer{ std::move(socket), std::deque<SharedSpectatorFrame>(), 0, NET_NO_BASELINE, true, false }));
+    }
+
+    void enqueue(Viewer& viewer, const SharedSpectatorFrame& frame) {
+        bool keyframe = frame->baselineTick == NET_NO_BASELINE;
+        if (!keyframe) {
+            // A caught-up viewer holding this delta's baseline goes back to every frame
+            if (viewer.keyframesOnly && viewer.queue.empty() && frame->baselineTick == viewer.lastTick)
+                viewer.keyframesOnly = false;
+            if (viewer.keyframesOnly || frame->baselineTick != viewer.lastTick) {
+                ++relay.framesSkipped;
+                return;
+            }
+        }
+
+        if (viewer.queue.size() >= MAX_QUEUED_FRAMES) {
+            // Slow consumer: drop what it has not started on; a frame half
+            // written has to be finished or the stream loses its framing
+            ++relay.slowViewerDrops;
+            relay.framesSkipped += viewer.queue.size() - (viewer.sentOfFront > 0 ? 1 : 0);
+            viewer.queue.resize(viewer.sentOfFront > 0 ? 1 : 0);
+            viewer.keyframesOnly = true;
+            viewer.lastTick = viewer.queue.empty() ? NET_NO_BASELINE : viewer.queue.front()->tick;
+            if (!keyframe) {
+                ++relay.framesSkipped;
+                return;
+            }
+        }
+        viewer.queue.push_back(frame);
+        viewer.lastTick = frame->tick;
+    }
+
+    void flush(Viewer& viewer) {
+        while (!viewer.closed && !viewer.queue.empty()) {
+            const std::vector<std::uint8_t>& bytes = viewer.queue.front()->bytes;
+            std::size_t sent = 0;
+            sf::Socket::Status status = viewer.socket->send(bytes.data() + viewer.sentOfFront, bytes.size() - viewer.sentOfFront, sent);
+            viewer.sentOfFront += sent;
+            relay.bytesSent += sent;
+            if (viewer.sentOfFront == bytes.size()) {
+                viewer.queue.pop_front();
+                viewer.sentOfFront = 0;
+            }
+            else if (status == sf::Socket::Partial || status == sf::Socket::NotReady || status == sf::Socket::Done) {
+                return; // The socket buffer is full; carry on next pass
+            }
+            else {
+                viewer.closed = true;
+            }
+        }
+    }
+
+    // Viewers send nothing, so a readable socket has closed (or is misbehaving)
+    void pollDisconnects() {
+        if (viewers.empty() || !selector.wait(DISCONNECT_POLL))
+            return;
+        for (std::unique_ptr<Viewer>& viewer : viewers) {
+            if (!selector.isReady(*viewer->socket))
+                continue;
+            char discard[256];
+            std::size_t received;
+            sf::Socket::Status status = viewer->socket->receive(discard, sizeof(discard), received);
+            if (status == sf::Socket::Disconnected || status == sf::Socket::Error)
+                viewer->closed = true;
+        }
+    }
+
+    void removeClosedViewers() {
+        for (std::size_t i = 0; i < viewers.size();) {
+            if (!viewers[i]->closed) {
+                ++i;
+                continue;
+            }
+            selector.remove(*viewers[i]->socket);
+            viewers[i] = std::move(viewers.back());
+            viewers.pop_back();
+            --viewerCount;
+        }
+    }
+
+    SpectatorRelay& relay;
+    sf::SocketSelector selector;
+    std::vector<std::unique_ptr<Viewer>> viewers;
+    std::atomic<std::size_t> viewerCount;
+
+    std::mutex inboxMutex;
+    std::condition_variable inboxChanged;
+    std::vector<std::unique_ptr<sf::TcpSocket>> newSockets;
+    std::vector<SharedSpectatorFrame> newFrames;
+    bool stopping;
+
+    std::thread thread;
+};
+
+const std::size_t SpectatorRelay::VIEWERS_PER_SELECTOR;
+const std::size_t SpectatorRelay::MAX_QUEUED_FRAMES;
+
+SpectatorRelay::SpectatorRelay()
+    : stopping(false),
+      havePrevious(false),
+      framesSinceKeyframe(0) {
+    resetStats();
+}
+
+SpectatorRelay::~SpectatorRelay() {
+    std::lock_guard<std::mutex> lock(workersMutex);
+    workers.clear();
+}
+
+bool SpectatorRelay::listen(unsigned short port) {
+    if (listener.listen(port) != sf::Socket::Done) {
+        std::cerr << "Failed to listen on port " << port << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void SpectatorRelay::run() {
+    sf::SocketSelector acceptSelector;
+    acceptSelector.add(listener);
+    while (!stopping) {
+        if (!acceptSelector.wait(ACCEPT_POLL_INTERVAL))
+            continue;
+        std::unique_ptr<sf::TcpSocket> socket(new sf::TcpSocket());
+        if (listener.accept(*socket) != sf::Socket::Done)
+            continue;
+
+        // Fill the least busy worker; start another when they are all full
+        std::lock_guard<std::mutex> lock(workersMutex);
+        Worker* target = nullptr;
+        for (std::unique_ptr<Worker>& worker : workers) {
+            if (worker->getViewerCount() < VIEWERS_PER_SELECTOR && (!target || worker->getViewerCount() < target->getViewerCount()))
+                target = worker.get();
+        }
+        if (!target) {
+            workers.push_back(std::unique_ptr<Worker>(new Worker(*this)));
+            target = workers.back().get();
+        }
+        target->add(std::move(socket));
+    }
+    std::lock_guard<std::mutex> lock(workersMutex);
+    workers.clear();
+    listener.close();
+}
+
+void SpectatorRelay::publish(const NetSnapshot& snapshot) {
+    sf::Clock encodeClock;
+    bool keyframe = !havePrevious || framesSinceKeyframe + 1 >= SPECTATOR_KEYFRAME_INTERVAL;
+    encodeSnapshot(snapshot, keyframe ? nullptr : &previous, encoded);
+
+    // Size prefix, then the same Snapshot message the UDP clients get
+    const std::size_t headerSize = 4 + 1 + 4 + 4;
+    std::shared_ptr<SpectatorFrame> frame = std::make_shared<SpectatorFrame>();
+    frame->tick = snapshot.tick;
+    frame->baselineTick = keyframe ? NET_NO_BASELINE : previous.tick;
+    frame->bytes.resize(headerSize + encoded.size());
+    putUint32(frame->bytes, 0, static_cast<std::uint32_t>(frame->bytes.size() - 4));
+    frame->bytes[4] = static_cast<std::uint8_t>(NetMessage::Snapshot);
+    putUint32(frame->bytes, 5, frame->tick);
+    putUint32(frame->bytes, 9, frame->baselineTick);
+    std::copy(encoded.begin(), encoded.end(), frame->bytes.begin() + headerSize);
+
+    previous = snapshot;
+    havePrevious = true;
+    framesSinceKeyframe = keyframe ? 0 : framesSinceKeyframe + 1;
+    ++framesPublished;
+    if (keyframe)
+        ++keyframes;
+    bytesEncoded += frame->bytes.size();
+    encodeMicroseconds += encodeClock.getElapsedTime().asMicroseconds();
+
+    SharedSpectatorFrame shared = frame;
+    std::lock_guard<std::mutex> lock(workersMutex);
+    for (std::unique_ptr<Worker>& worker : workers)
+        worker->push(shared);
+}
+
+SpectatorRelay::Stats SpectatorRelay::getStats() const {
+    Stats stats;
+    stats.viewers = 0;
+    {
+        std::lock_guard<std::mutex> lock(workersMutex);
+        for (const std::unique_ptr<Worker>& worker : workers)
+            stats.viewers += static_cast<int>(worker->getViewerCount());
+    }
+    stats.framesPublished = framesPublished;
+    stats.keyframes = keyframes;
+    stats.bytesEncoded = bytesEncoded;
+    stats.bytesSent = bytesSent;
+    stats.framesSkipped = framesSkipped;
+    stats.slowViewerDrops = slowViewerDrops;
+    stats.encodeSeconds = encodeMicroseconds / 1e6;
+    stats.workerSeconds = workerMicroseconds / 1e6;
+    return stats;
+}
+
+void SpectatorRelay::resetStats() {
+    framesPublished = 0;
+    keyframes = 0;
+    bytesEncoded = 0;
+    bytesSent = 0;
+    framesSkipped = 0;
+    slowViewerDrops = 0;
+    encodeMicroseconds = 0;
+    workerMicroseconds = 0;
+}
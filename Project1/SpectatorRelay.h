@@ -0,0 +1,93 @@
+#ifndef SPECTATORRELAY_H
+#define SPECTATORRELAY_H
+
+#include <SFML/Network.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "NetProtocol.h"
+#include "NetSnapshot.h"
+
+// One encoded frame, exactly as it goes on the wire: the sf::Packet size
+// prefix followed by a Snapshot message. Immutable once published, so every
+// viewer's queue holds a reference to the same bytes.
+struct SpectatorFrame {
+    std::vector<std::uint8_t> bytes;
+    std::uint32_t tick;
+    std::uint32_t baselineTick; // NET_NO_BASELINE for a keyframe
+};
+
+typedef std::shared_ptr<const SpectatorFrame> SharedSpectatorFrame;
+
+// Fans a live game out to spectators over TCP.
+// publish() encodes each snapshot once, as a delta against the previous one
+// or as a keyframe, and hands the shared frame to the workers. Each worker
+// owns up to VIEWERS_PER_SELECTOR viewers and writes the frame bytes straight
+// from the shared buffer, without an sf::Packet copy per viewer. A viewer
+// whose queue reaches MAX_QUEUED_FRAMES is behind: its unsent frames are
+// dropped and it gets only keyframes until it has caught up again.
+class SpectatorRelay {
+public:
+    // Windows select() watches at most 64 sockets unless FD_SETSIZE is raised
+    static const std::size_t VIEWERS_PER_SELECTOR = 63;
+    // About two seconds of frames
+    static const std::size_t MAX_QUEUED_FRAMES = 2 * NET_SNAPSHOT_RATE;
+
+    struct Stats {
+        int viewers;
+        std::uint64_t framesPublished;
+        std::uint64_t keyframes;
+        std::uint64_t bytesEncoded; // Once per frame, however many viewers
+        std::uint64_t bytesSent;
+        std::uint64_t framesSkipped; // Deltas not sent to viewers waiting for a keyframe
+        std::uint64_t slowViewerDrops; // Times a viewer fell MAX_QUEUED_FRAMES behind
+        double encodeSeconds;
+        double workerSeconds; // Time the workers spent queueing, sending and polling
+    };
+
+    SpectatorRelay();
+    ~SpectatorRelay();
+    SpectatorRelay(const SpectatorRelay&) = delete;
+    SpectatorRelay& operator=(const SpectatorRelay&) = delete;
+
+    bool listen(unsigned short port);
+    // Accepts viewers until stop() is called from another thread
+    void run();
+    void stop() { stopping = true; }
+
+    // Called from the simulation thread at the snapshot rate
+    void publish(const NetSnapshot& snapshot);
+
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    class Worker;
+
+    sf::TcpListener listener;
+    std::atomic<bool> stopping;
+
+    // run() adds workers while publish() hands them frames
+    mutable std::mutex workersMutex;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    NetSnapshot previous;
+    bool havePrevious;
+    int framesSinceKeyframe;
+    std::vector<std::uint8_t> encoded;
+
+    std::atomic<std::uint64_t> framesPublished;
+    std::atomic<std::uint64_t> keyframes;
+    std::atomic<std::uint64_t> bytesEncoded;
+    std::atomic<std::uint64_t> bytesSent;
+    std::atomic<std::uint64_t> framesSkipped;
+    std::atomic<std::uint64_t> slowViewerDrops;
+    std::atomic<std::uint64_t> encodeMicroseconds;
+    std::atomic<std::uint64_t> workerMicroseconds;
+};
+
+#endif // SPECTATORRELAY_H
@@ -0,0 +1,63 @@
+#include "SpriteBatch.h"
+
+void SpriteBatch::begin() {
+    for (std::size_t i = 0; i < activePages; ++i)
+        pages[i].used = 0;
+    activePages = 0;
+}
+
+SpriteBatch::Page& SpriteBatch::pageFor(const sf::Texture& texture) {
+    // Only a handful of pages are live per frame, a linear scan is cheapest
+    for (std::size_t i = 0; i < activePages; ++i) {
+        if (pages[i].texture == &texture)
+            return pages[i];
+    }
+
+    if (activePages == pages.size())
+        pages.push_back(Page());
+    Page& page = pages[activePages++];
+    page.texture = &texture;
+    page.used = 0;
+    return page;
+}
+
+void SpriteBatch::draw(const sf::Texture& texture, const sf::IntRect& textureRect, float posX, float posY, float scaleX, float scaleY) {
+    Page& page = pageFor(texture);
+    if (page.used + VERTICES_PER_SPRITE > page.vertices.size())
+        page.vertices.resize((page.used + VERTICES_PER_SPRITE) * 2);
+
+    float left = posX;
+    float top = posY;
+    float right = posX + textureRect.width * scaleX;
+    float bottom = posY + textureRect.height * scaleY;
+
+    float texLeft = static_cast<float>(textureRect.left);
+    float texTop = static_cast<float>(textureRect.top);
+    float texRight = static_cast<float>(textureRect.left + textureRect.width);
+    float texBottom = static_cast<float>(textureRect.top + textureRect.height);
+
+    // Two triangles per quad
+    sf::Vertex* quad = &page.vertices[page.used];
+    quad[0] = sf::Vertex(sf::Vector2f(left, top), sf::Vector2f(texLeft, texTop));
+    quad[1] = sf::Vertex(sf::Vector2f(right, top), sf::Vector2f(texRight, texTop));
+    quad[2] = sf::Vertex(sf::Vector2f(left, bottom), sf::Vector2f(texLeft, texBottom));
+    quad[3] = quad[2];
+    quad[4] = quad[1];
+    quad[5] = sf::Vertex(sf::Vector2f(right, bottom), sf::Vector2f(texRight, texBottom));
+    page.used += VERTICES_PER_SPRITE;
+}
+
+void SpriteBatch::flush(sf::RenderTarget& target, sf::RenderStates states) {
+    lastDrawCalls = 0;
+    lastVertexCount = 0;
+    for (std::size_t i = 0; i < activePages; ++i) {
+        Page& page = pages[i];
+        if (page.used == 0)
+            continue;
+        states.texture = page.texture;
+        target.draw(page.vertices.data(), page.used, sf::Triangles, states);
+        ++lastDrawCalls;
+        lastVertexCount += page.used;
+    }
+    begin();
+}
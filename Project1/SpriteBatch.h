@@ -0,0 +1,40 @@
+#ifndef SPRITEBATCH_H
+#define SPRITEBATCH_H
+
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <vector>
+
+// Collects textured quads per texture page and submits each page with a
+// single draw call. Pages are flushed in the order they were first used in
+// the frame, and quads keep their submission order inside a page. Vertex
+// storage is kept between frames, so a steady frame does not allocate.
+class SpriteBatch {
+public:
+    void begin();
+    void draw(const sf::Texture& texture, const sf::IntRect& textureRect, float posX, float posY, float scaleX = 1.0f, float scaleY = 1.0f);
+    void flush(sf::RenderTarget& target, sf::RenderStates states = sf::RenderStates::Default);
+
+    // Counters for the last flushed frame
+    std::size_t drawCalls() const { return lastDrawCalls; }
+    std::size_t vertexCount() const { return lastVertexCount; }
+    std::size_t spriteCount() const { return lastVertexCount / VERTICES_PER_SPRITE; }
+
+    static const std::size_t VERTICES_PER_SPRITE = 6;
+
+private:
+    struct Page {
+        const sf::Texture* texture;
+        std::vector<sf::Vertex> vertices;
+        std::size_t used;
+    };
+
+    Page& pageFor(const sf::Texture& texture);
+
+    std::vector<Page> pages;
+    std::size_t activePages = 0;
+    std::size_t lastDrawCalls = 0;
+    std::size_t lastVertexCount = 0;
+};
+
+#endif // SPRITEBATCH_H
@@ -0,0 +1,269 @@
+#include "TextureAtlas.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iterator>
+
+namespace {
+
+// Smallest rectangle holding every non-transparent pixel
+sf::IntRect opaqueBounds(const sf::Image& image) {
+    sf::Vector2u size = image.getSize();
+    int left = static_cast<int>(size.x), top = static_cast<int>(size.y), right = -1, bottom = -1;
+    for (unsigned y = 0; y < size.y; ++y) {
+        for (unsigned x = 0; x < size.x; ++x) {
+            if (image.getPixel(x, y).a == 0)
+                continue;
+            left = std::min(left, static_cast<int>(x));
+            top = std::min(top, static_cast<int>(y));
+            right = std::max(right, static_cast<int>(x));
+            bottom = std::max(bottom, static_cast<int>(y));
+        }
+    }
+    // Fully transparent images keep one pixel so they still have a region
+    if (right < 0)
+        return sf::IntRect(0, 0, 1, 1);
+    return sf::IntRect(left, top, right - left + 1, bottom - top + 1);
+}
+
+std::string directoryOf(const std::string& path) {
+    std::size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+} // namespace
+
+bool TextureAtlas::build(const std::vector<AtlasSource>& sources, int padding, int extrude) {
+    struct Entry {
+        const AtlasSource* source;
+        sf::Image image;
+        sf::IntRect trimmed;
+    };
+
+    // Decode every source and find its trimmed bounds
+    std::vector<Entry> entries(sources.size());
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+        entries[i].source = &sources[i];
+        if (!entries[i].image.loadFromFile(sources[i].file)) {
+            std::cerr << "Failed to load atlas source: " << sources[i].file << std::endl;
+            return false;
+        }
+        sf::Vector2u size = entries[i].image.getSize();
+        entries[i].trimmed = sources[i].trim ? opaqueBounds(entries[i].image) : sf::IntRect(0, 0, size.x, size.y);
+    }
+
+    // Tallest first keeps the shelves tight
+    std::vector<std::size_t> order(entries.size());
+    for (std::size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return entries[a].trimmed.height > entries[b].trimmed.height;
+    });
+
+    // Shelf packing; each cell carries the extruded border plus padding
+    int border = extrude + padding;
+    std::vector<sf::Vector2i> pageExtent(1, sf::Vector2i(0, 0));
+    int shelfX = 0, shelfY = 0, shelfHeight = 0;
+    std::vector<sf::Vector2i> cellPos(entries.size());
+    std::vector<int> cellPage(entries.size());
+    regions.clear();
+
+    for (std::size_t index : order) {
+        const sf::IntRect& trimmed = entries[index].trimmed;
+        int cellWidth = trimmed.width + 2 * border;
+        int cellHeight = trimmed.height + 2 * border;
+        if (cellWidth > MAX_PAGE_SIZE || cellHeight > MAX_PAGE_SIZE) {
+            std::cerr << "Atlas source does not fit a page: " << entries[index].source->file << std::endl;
+            return false;
+        }
+
+        // Next shelf, or next page when the shelves run out
+        if (shelfX + cellWidth > MAX_PAGE_SIZE) {
+            shelfX = 0;
+            shelfY += shelfHeight;
+            shelfHeight = 0;
+        }
+        if (shelfY + cellHeight > MAX_PAGE_SIZE) {
+            pageExtent.push_back(sf::Vector2i(0, 0));
+            shelfX = 0;
+            shelfY = 0;
+            shelfHeight = 0;
+        }
+
+        int page = static_cast<int>(pageExtent.size()) - 1;
+        cellPos[index] = sf::Vector2i(shelfX, shelfY);
+        cellPage[index] = page;
+        pageExtent[page].x = std::max(pageExtent[page].x, shelfX + cellWidth);
+        pageExtent[page].y = std::max(pageExtent[page].y, shelfY + cellHeight);
+        shelfX += cellWidth;
+        shelfHeight = std::max(shelfHeight, cellHeight);
+    }
+
+    // Pages are only as large as their contents, not MAX_PAGE_SIZE squared
+    pageImages.assign(pageExtent.size(), sf::Image());
+    pageTextures.clear();
+    for (std::size_t page = 0; page < pageExtent.size(); ++page)
+        pageImages[page].create(std::max(1, pageExtent[page].x), std::max(1, pageExtent[page].y), sf::Color::Transparent);
+
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        const sf::IntRect& trimmed = entries[i].trimmed;
+        sf::Image& pageImage = pageImages[cellPage[i]];
+        int destX = cellPos[i].x + border;
+        int destY = cellPos[i].y + border;
+        pageImage.copy(entries[i].image, destX, destY, trimmed);
+
+        // Extrude the edge pixels outwards so filtering never samples a neighbour
+        for (int e = 1; e <= extrude; ++e) {
+            for (int x = -e; x < trimmed.width + e; ++x) {
+                int sx = std::max(0, std::min(trimmed.width - 1, x));
+                pageImage.setPixel(destX + x, destY - e, pageImage.getPixel(destX + sx, destY));
+                pageImage.setPixel(destX + x, destY + trimmed.height - 1 + e, pageImage.getPixel(destX + sx, destY + trimmed.height - 1));
+            }
+            for (int y = 0; y < trimmed.height; ++y) {
+                pageImage.setPixel(destX - e, destY + y, pageImage.getPixel(destX, destY + y));
+                pageImage.setPixel(destX + trimmed.width - 1 + e, destY + y, pageImage.getPixel(destX + trimmed.width - 1, destY + y));
+            }
+        }
+
+        AtlasRegion region;
+        region.page = cellPage[i];
+        region.rect = sf::IntRect(destX, destY, trimmed.width, trimmed.height);
+        region.offset = sf::Vector2i(trimmed.left, trimmed.top);
+        region.sourceSize = sf::Vector2i(entries[i].image.getSize());
+        regions[entries[i].source->name] = region;
+    }
+
+    return true;
+}
+
+bool TextureAtlas::save(const std::string& manifestFile) const {
+    std::ofstream manifest(manifestFile);
+    if (!manifest.is_open()) {
+        std::cerr << "Failed to write atlas manifest: " << manifestFile << std::endl;
+        return false;
+    }
+
+    // Page images are written next to the manifest
+    std::string directory = directoryOf(manifestFile);
+    manifest << "# Generated texture atlas\n";
+    manifest << "# region <name> <page> <x> <y> <width> <height> <offsetX> <offsetY> <sourceWidth> <sourceHeight>\n";
+    for (std::size_t page = 0; page < pageImages.size(); ++page) {
+        std::string pageFile = "atlas" + std::to_string(page) + ".png";
+        if (!pageImages[page].saveToFile(directory + pageFile)) {
+            std::cerr << "Failed to write atlas page: " << directory + pageFile << std::endl;
+            return false;
+        }
+        manifest << "page " << pageFile << "\n";
+    }
+    for (const auto& entry : regions) {
+        const AtlasRegion& region = entry.second;
+        manifest << "region " << entry.first << ' ' << region.page << ' '
+            << region.rect.left << ' ' << region.rect.top << ' ' << region.rect.width << ' ' << region.rect.height << ' '
+            << region.offset.x << ' ' << region.offset.y << ' ' << region.sourceSize.x << ' ' << region.sourceSize.y << "\n";
+    }
+    return true;
+}
+
+std::vector<std::string> TextureAtlas::manifestFiles(const std::string& manifestFile) {
+    std::vector<std::string> files;
+    std::ifstream manifest(manifestFile);
+    if (!manifest.is_open())
+        return files;
+
+    files.push_back(manifestFile);
+    std::string line;
+    while (std::getline(manifest, line)) {
+        std::istringstream iss(line);
+        std::string keyword, pageFile;
+        if ((iss >> keyword >> pageFile) && keyword == "page")
+            files.push_back(directoryOf(manifestFile) + pageFile);
+    }
+    return files;
+}
+
+bool TextureAtlas::load(const std::string& manifestFile, const AssetPack* pack) {
+    std::string text;
+    if (!pack || !pack->readText(manifestFile, text)) {
+        std::ifstream file(manifestFile);
+        if (!file.is_open())
+            return false;
+        text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    std::istringstream manifest(text);
+
+    std::string directory = directoryOf(manifestFile);
+    pageImages.clear();
+    pageTextures.clear();
+    regions.clear();
+
+    std::string line;
+    while (std::getline(manifest, line)) {
+        std::istringstream iss(line);
+        std::string keyword;
+        if (!(iss >> keyword) || keyword[0] == '#')
+            continue;
+
+        if (keyword == "page") {
+            std::string pageFile;
+            iss >> pageFile;
+            pageImages.push_back(sf::Image());
+            std::string pagePath = directory + pageFile;
+            bool loaded = pack && pack->contains(pagePath) ? pack->loadImage(pagePath, pageImages.back())
+                                                           : pageImages.back().loadFromFile(pagePath);
+            if (!loaded) {
+                std::cerr << "Failed to load atlas page: " << directory + pageFile << std::endl;
+                return false;
+            }
+        }
+        else if (keyword == "region") {
+            std::string name;
+            AtlasRegion region;
+            if (!(iss >> name >> region.page >> region.rect.left >> region.rect.top >> region.rect.width >> region.rect.height
+                      >> region.offset.x >> region.offset.y >> region.sourceSize.x >> region.sourceSize.y)) {
+                std::cerr << "Malformed atlas manifest line: " << line << std::endl;
+                return false;
+            }
+            regions[name] = region;
+        }
+    }
+
+    // Regions are checked once every page is known, so a bad index or rect
+    // fails here instead of sampling outside a page later
+    for (const auto& entry : regions) {
+        const AtlasRegion& region = entry.second;
+        if (region.page < 0 || static_cast<std::size_t>(region.page) >= pageImages.size()) {
+            std::cerr << "Atlas region " << entry.first << " names missing page " << region.page << std::endl;
+            return false;
+        }
+        sf::Vector2u pageSize = pageImages[region.page].getSize();
+        const sf::IntRect& rect = region.rect;
+        if (rect.left < 0 || rect.top < 0 || rect.width < 0 || rect.height < 0
+            || static_cast<unsigned int>(rect.left) + static_cast<unsigned int>(rect.width) > pageSize.x
+            || static_cast<unsigned int>(rect.top) + static_cast<unsigned int>(rect.height) > pageSize.y) {
+            std::cerr << "Atlas region " << entry.first << " lies outside page " << region.page << std::endl;
+            return false;
+        }
+    }
+    return !pageImages.empty();
+}
+
+bool TextureAtlas::upload(ResourceCache& resources, const std::string& key) {
+    pageTextures.clear();
+    pageTextures.reserve(pageImages.size());
+    for (std::size_t page = 0; page < pageImages.size(); ++page) {
+        std::shared_ptr<sf::Texture> texture = std::make_shared<sf::Texture>();
+        if (!texture->loadFromImage(pageImages[page])) {
+            std::cerr << "Failed to upload atlas page " << page << std::endl;
+            return false;
+        }
+        pageTextures.push_back(resources.addTexture(key + "#" + std::to_string(page), texture));
+    }
+    pageImages.clear();
+    return true;
+}
+
+const AtlasRegion* TextureAtlas::find(const std::string& name) const {
+    auto it = regions.find(name);
+    return it == regions.end() ? nullptr : &it->second;
+}
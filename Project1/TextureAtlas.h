@@ -0,0 +1,54 @@
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+
+#include <SFML/Graphics.hpp>
+#include <map>
+#include <string>
+#include <vector>
+#include "ResourceCache.h"
+
+// One image to pack, referenced by name at runtime
+struct AtlasSource {
+    std::string name;
+    std::string file;
+    bool trim; // Strip transparent borders; leave off for frame strips indexed by position
+};
+
+// Where a named image ended up
+struct AtlasRegion {
+    int page;
+    sf::IntRect rect;        // Packed (possibly trimmed) pixels inside the page
+    sf::Vector2i offset;     // Position of rect inside the untrimmed source image
+    sf::Vector2i sourceSize; // Size of the original image
+};
+
+// Packs separate sprite images into a few texture pages.
+// build() runs on the CPU only (shelf packing, trimming, edge extrusion) and
+// can be used offline with save(), or at startup when no manifest exists.
+// load() reads a saved manifest and its page images, from an asset pack
+// when one is given and holds them; upload() then turns
+// the pages into textures registered in the resource cache as "<key>#<page>"
+// and frees the CPU copies.
+class TextureAtlas {
+public:
+    static const int MAX_PAGE_SIZE = 2048;
+
+    bool build(const std::vector<AtlasSource>& sources, int padding = 2, int extrude = 1);
+    bool save(const std::string& manifestFile) const;
+    bool load(const std::string& manifestFile, const AssetPack* pack = nullptr);
+    bool upload(ResourceCache& resources, const std::string& key);
+
+    // The manifest and the page images it names, for packing
+    static std::vector<std::string> manifestFiles(const std::string& manifestFile);
+
+    const AtlasRegion* find(const std::string& name) const;
+    const sf::Texture& pageTexture(int page) const { return *pageTextures[page]; }
+    std::size_t pageCount() const { return pageImages.empty() ? pageTextures.size() : pageImages.size(); }
+
+private:
+    std::vector<sf::Image> pageImages;
+    std::vector<TextureHandle> pageTextures;
+    std::map<std::string, AtlasRegion> regions;
+};
+
+#endif // TEXTUREATLAS_H
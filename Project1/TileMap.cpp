@@ -1,48 +1,388 @@
 #include "TileMap.h"
+#include "MapFile.h"
+#include "Tileset.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
-TileMap::TileMap(const std::string& tilesetFile, int tileSize, int mapWidth, int mapHeight)
-    : tileSize(tileSize) {
-    // Load tileset texture
-    if (!tilesetTexture.loadFromFile(tilesetFile)) {
-        std::cerr << "Failed to load tileset texture: " << tilesetFile << std::endl;
-        exit(1);
-    }
+// Vertices per tile quad (two triangles)
+const std::size_t VERTICES_PER_TILE = 6;
+
+TileMap::TileMap(ResourceCache& resources, const std::string& tilesetFile, const std::string& textMapFile, int tileSize, int mapWidth, int mapHeight)
+    : tileSize(tileSize),
+      mapWidth(mapWidth),
+      mapHeight(mapHeight),
+      layerCount(1),
+      chunksAcross((mapWidth + CHUNK_SIZE - 1) / CHUNK_SIZE),
+      chunksDown((mapHeight + CHUNK_SIZE - 1) / CHUNK_SIZE),
+      maxResidentChunks(DEFAULT_MAX_RESIDENT_CHUNKS),
+      frameChunkLimit(DEFAULT_MAX_RESIDENT_CHUNKS),
+      lruHead(-1),
+      lruTail(-1),
+      lastDrawCalls(0),
+      chunkBuilds(0),
+      loaded(true) {
+    if (!loadTileset(resources, tilesetFile))
+        return;
 
     // Read map data from a file
-    std::ifstream mapFile("map.txt");
+    std::ifstream mapFile(textMapFile);
     if (!mapFile.is_open()) {
-        std::cerr << "Failed to open map file: map.txt" << std::endl;
-        exit(1);
+        std::cerr << "Failed to open map file: " << textMapFile << std::endl;
+        clear();
+        return;
     }
 
+    tiles.reserve(static_cast<std::size_t>(mapWidth) * mapHeight);
     std::string line;
     while (std::getline(mapFile, line)) {
         std::istringstream iss(line);
         int tileIndex;
         while (iss >> tileIndex) {
-            tileData.push_back({ tileIndex, sf::Vector2f(tileSize * tileData.size(), tileSize) });
+            tiles.push_back(static_cast<std::uint16_t>(tileIndex));
         }
     }
 
     mapFile.close();
+
+    // Missing tiles are left empty, extra ones ignored
+    tiles.resize(static_cast<std::size_t>(mapWidth) * mapHeight, 0);
+}
+
+TileMap::TileMap(ResourceCache& resources, const std::string& tilesetFile, const std::string& binaryMapFile)
+    : tileSize(0),
+      mapWidth(0),
+      mapHeight(0),
+      layerCount(0),
+      chunksAcross(0),
+      chunksDown(0),
+      maxResidentChunks(DEFAULT_MAX_RESIDENT_CHUNKS),
+      frameChunkLimit(DEFAULT_MAX_RESIDENT_CHUNKS),
+      lruHead(-1),
+      lruTail(-1),
+      lastDrawCalls(0),
+      chunkBuilds(0),
+      loaded(true) {
+    if (!loadTileset(resources, tilesetFile))
+        return;
+
+    MapFileReader reader;
+    if (!reader.open(binaryMapFile)) {
+        clear();
+        return;
+    }
+
+    const MapFileHeader& header = reader.header();
+    tileSize = static_cast<int>(header.tileSize);
+    mapWidth = static_cast<int>(header.width);
+    mapHeight = static_cast<int>(header.height);
+    layerCount = static_cast<int>(header.layers);
+    chunksAcross = (mapWidth + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    chunksDown = (mapHeight + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    // One bulk copy out of the mapping: the mapped pages belong to the file
+    // cache, so the tile vector is the only private copy ever held
+    tiles.resize(reader.tileCount());
+    std::memcpy(tiles.data(), reader.tiles(), tiles.size() * sizeof(std::uint16_t));
+}
+
+TileMap::TileMap(ResourceCache& resources, const std::string& tilesetFile, int tileSize, int mapWidth, int mapHeight, int layers, TileGenerator generator)
+    : tileSize(tileSize),
+      mapWidth(mapWidth),
+      mapHeight(mapHeight),
+      layerCount(layers),
+      chunksAcross((mapWidth + CHUNK_SIZE - 1) / CHUNK_SIZE),
+      chunksDown((mapHeight + CHUNK_SIZE - 1) / CHUNK_SIZE),
+      generator(generator),
+      maxResidentChunks(DEFAULT_MAX_RESIDENT_CHUNKS),
+      frameChunkLimit(DEFAULT_MAX_RESIDENT_CHUNKS),
+      lruHead(-1),
+      lruTail(-1),
+      lastDrawCalls(0),
+      chunkBuilds(0),
+      loaded(true) {
+    loadTileset(resources, tilesetFile);
+}
+
+TileMap::TileMap(ResourceCache& resources, const Tileset& tileset, int mapWidth, int mapHeight, int layers)
+    : tileSize(tileset.getTileSize()),
+      mapWidth(mapWidth),
+      mapHeight(mapHeight),
+      layerCount(layers),
+      chunksAcross((mapWidth + CHUNK_SIZE - 1) / CHUNK_SIZE),
+      chunksDown((mapHeight + CHUNK_SIZE - 1) / CHUNK_SIZE),
+      maxResidentChunks(DEFAULT_MAX_RESIDENT_CHUNKS),
+      frameChunkLimit(DEFAULT_MAX_RESIDENT_CHUNKS),
+      lruHead(-1),
+      lruTail(-1),
+      lastDrawCalls(0),
+      chunkBuilds(0),
+      loaded(true) {
+    if (!loadTileset(resources, tileset.getTexturePath()))
+        return;
+    tiles.assign(static_cast<std::size_t>(mapWidth) * mapHeight * layers, tileset.getEmptyTile());
 }
 
 TileMap::~TileMap() {
 }
 
+bool TileMap::loadTileset(ResourceCache& resources, const std::string& tilesetFile) {
+    // Maps sharing a tileset share its texture; the cache reports load failures
+    tilesetTexture = resources.getTexture(tilesetFile);
+    if (!tilesetTexture)
+        clear();
+    return loaded;
+}
+
+void TileMap::clear() {
+    // An empty map: render, setTile and setLayer all become no-ops
+    loaded = false;
+    mapWidth = 0;
+    mapHeight = 0;
+    layerCount = 0;
+    chunksAcross = 0;
+    chunksDown = 0;
+    tiles.clear();
+}
+
 void TileMap::update(float deltaTime) {
     // No updates needed for a static tilemap
 }
 
+std::uint16_t TileMap::getTile(int x, int y, int layer) const {
+    return tiles.empty() ? generator(x, y, layer) : tiles[tileOffset(x, y, layer)];
+}
+
+void TileMap::setMaxResidentChunks(std::size_t count) {
+    maxResidentChunks = std::max<std::size_t>(1, count);
+    frameChunkLimit = maxResidentChunks;
+    trimChunks(maxResidentChunks);
+}
+
+void TileMap::trimChunks(std::size_t limit) {
+    while (chunkSlots.size() > limit) {
+        // Free the least recently drawn chunk and move the last slot into its place
+        int slot = lruTail;
+        int last = static_cast<int>(chunkSlots.size()) - 1;
+        lruUnlink(slot);
+        chunkSlotOf.erase(chunkSlots[slot]->key);
+        if (slot != last) {
+            Chunk& moved = *chunkSlots[last];
+            if (moved.lruPrev >= 0)
+                chunkSlots[moved.lruPrev]->lruNext = slot;
+            else
+                lruHead = slot;
+            if (moved.lruNext >= 0)
+                chunkSlots[moved.lruNext]->lruPrev = slot;
+            else
+                lruTail = slot;
+            chunkSlotOf[moved.key] = slot;
+            std::swap(chunkSlots[slot], chunkSlots[last]);
+        }
+        chunkSlots.pop_back();
+    }
+}
+
+void TileMap::lruUnlink(int slot) {
+    Chunk& chunk = *chunkSlots[slot];
+    if (chunk.lruPrev >= 0)
+        chunkSlots[chunk.lruPrev]->lruNext = chunk.lruNext;
+    else
+        lruHead = chunk.lruNext;
+    if (chunk.lruNext >= 0)
+        chunkSlots[chunk.lruNext]->lruPrev = chunk.lruPrev;
+    else
+        lruTail = chunk.lruPrev;
+    chunk.lruPrev = -1;
+    chunk.lruNext = -1;
+}
+
+void TileMap::lruPushFront(int slot) {
+    Chunk& chunk = *chunkSlots[slot];
+    chunk.lruPrev = -1;
+    chunk.lruNext = lruHead;
+    if (lruHead >= 0)
+        chunkSlots[lruHead]->lruPrev = slot;
+    lruHead = slot;
+    if (lruTail < 0)
+        lruTail = slot;
+}
+
+TileMap::Chunk& TileMap::acquireChunk(int chunkX, int chunkY) {
+    std::uint64_t key = chunkKey(chunkX, chunkY);
+    auto it = chunkSlotOf.find(key);
+    if (it != chunkSlotOf.end()) {
+        // Already resident: mark as most recently drawn
+        lruUnlink(it->second);
+        lruPushFront(it->second);
+        return *chunkSlots[it->second];
+    }
+
+    int slot;
+    if (chunkSlots.size() < frameChunkLimit) {
+        slot = static_cast<int>(chunkSlots.size());
+        chunkSlots.push_back(std::unique_ptr<Chunk>(new Chunk()));
+        chunkSlots[slot]->vertexBuffer.setPrimitiveType(sf::Triangles);
+        chunkSlots[slot]->vertexBuffer.setUsage(sf::VertexBuffer::Static);
+        chunkSlots[slot]->useVertexBuffer = sf::VertexBuffer::isAvailable();
+        chunkSlots[slot]->lruPrev = -1;
+        chunkSlots[slot]->lruNext = -1;
+    }
+    else {
+        // Recycle the least recently drawn chunk's storage
+        slot = lruTail;
+        lruUnlink(slot);
+        chunkSlotOf.erase(chunkSlots[slot]->key);
+    }
+
+    Chunk& chunk = *chunkSlots[slot];
+    chunk.key = key;
+    chunk.chunkX = chunkX;
+    chunk.chunkY = chunkY;
+    buildChunk(chunk);
+    chunkSlotOf[key] = slot;
+    lruPushFront(slot);
+    return chunk;
+}
+
+void TileMap::buildChunk(Chunk& chunk) {
+    chunk.width = std::min(CHUNK_SIZE, mapWidth - chunk.chunkX * CHUNK_SIZE);
+    chunk.height = std::min(CHUNK_SIZE, mapHeight - chunk.chunkY * CHUNK_SIZE);
+    chunk.vertices.resize(static_cast<std::size_t>(chunk.width) * chunk.height * layerCount * VERTICES_PER_TILE);
+
+    int firstX = chunk.chunkX * CHUNK_SIZE;
+    int firstY = chunk.chunkY * CHUNK_SIZE;
+    for (int layer = 0; layer < layerCount; ++layer) {
+        for (int y = firstY; y < firstY + chunk.height; ++y) {
+            for (int x = firstX; x < firstX + chunk.width; ++x)
+                writeQuad(chunk, x, y, layer);
+        }
+    }
+
+    // Recycled slots keep their GPU buffer when the size matches
+    if (chunk.useVertexBuffer && chunk.vertexBuffer.getVertexCount() != chunk.vertices.size()
+        && !chunk.vertexBuffer.create(chunk.vertices.size())) {
+        std::cerr << "Failed to create tilemap vertex buffer, drawing from client memory" << std::endl;
+        chunk.useVertexBuffer = false;
+    }
+    chunk.dirtyBegin = 0;
+    chunk.dirtyEnd = chunk.vertices.size();
+    ++chunkBuilds;
+}
+
+void TileMap::writeQuad(Chunk& chunk, int x, int y, int layer) {
+    int localX = x - chunk.chunkX * CHUNK_SIZE;
+    int localY = y - chunk.chunkY * CHUNK_SIZE;
+    float left = static_cast<float>(x) * tileSize;
+    float top = static_cast<float>(y) * tileSize;
+    float right = left + tileSize;
+    float bottom = top + tileSize;
+    // Tiles are numbered row by row across the tileset texture
+    int tile = getTile(x, y, layer);
+    int columns = std::max(1, static_cast<int>(tilesetTexture->getSize().x) / tileSize);
+    float texLeft = static_cast<float>((tile % columns) * tileSize);
+    float texTop = static_cast<float>((tile / columns) * tileSize);
+    float texRight = texLeft + tileSize;
+    float texBottom = texTop + tileSize;
+
+    std::size_t index = ((static_cast<std::size_t>(layer) * chunk.height + localY) * chunk.width + localX) * VERTICES_PER_TILE;
+    sf::Vertex* quad = &chunk.vertices[index];
+    quad[0] = sf::Vertex(sf::Vector2f(left, top), sf::Vector2f(texLeft, texTop));
+    quad[1] = sf::Vertex(sf::Vector2f(right, top), sf::Vector2f(texRight, texTop));
+    quad[2] = sf::Vertex(sf::Vector2f(left, bottom), sf::Vector2f(texLeft, texBottom));
+    quad[3] = quad[2];
+    quad[4] = quad[1];
+    quad[5] = sf::Vertex(sf::Vector2f(right, bottom), sf::Vector2f(texRight, texBottom));
+}
+
+void TileMap::setTile(int x, int y, std::uint16_t tileIndex, int layer) {
+    // Generated maps have no storage to edit
+    if (tiles.empty())
+        return;
+    if (x < 0 || y < 0 || layer < 0 || x >= mapWidth || y >= mapHeight || layer >= layerCount)
+        return;
+    std::size_t offset = tileOffset(x, y, layer);
+    if (tiles[offset] == tileIndex)
+        return;
+    tiles[offset] = tileIndex;
+
+    // Patch the quad if its chunk is resident; otherwise it is built fresh when next seen
+    auto it = chunkSlotOf.find(chunkKey(x / CHUNK_SIZE, y / CHUNK_SIZE));
+    if (it == chunkSlotOf.end())
+        return;
+    Chunk& chunk = *chunkSlots[it->second];
+    writeQuad(chunk, x, y, layer);
+
+    std::size_t first = ((static_cast<std::size_t>(layer) * chunk.height + (y - chunk.chunkY * CHUNK_SIZE)) * chunk.width + (x - chunk.chunkX * CHUNK_SIZE)) * VERTICES_PER_TILE;
+    if (chunk.dirtyBegin == chunk.dirtyEnd) {
+        chunk.dirtyBegin = first;
+        chunk.dirtyEnd = first + VERTICES_PER_TILE;
+    }
+    else {
+        chunk.dirtyBegin = std::min(chunk.dirtyBegin, first);
+        chunk.dirtyEnd = std::max(chunk.dirtyEnd, first + VERTICES_PER_TILE);
+    }
+}
+
+void TileMap::setLayer(int layer, const std::vector<std::uint16_t>& layerTiles) {
+    std::size_t layerSize = static_cast<std::size_t>(mapWidth) * mapHeight;
+    if (tiles.empty() || layer < 0 || layer >= layerCount || layerTiles.size() != layerSize)
+        return;
+    std::copy(layerTiles.begin(), layerTiles.end(), tiles.begin() + tileOffset(0, 0, layer));
+
+    // Every resident chunk shows part of the layer, so rebuild them in place
+    for (auto& entry : chunkSlotOf)
+        buildChunk(*chunkSlots[entry.second]);
+}
+
+void TileMap::drawChunk(sf::RenderTarget& target, Chunk& chunk) {
+    sf::RenderStates states;
+    states.texture = tilesetTexture.get();
+
+    if (chunk.useVertexBuffer) {
+        if (chunk.dirtyBegin != chunk.dirtyEnd) {
+            chunk.vertexBuffer.update(&chunk.vertices[chunk.dirtyBegin], chunk.dirtyEnd - chunk.dirtyBegin,
+                                      static_cast<unsigned int>(chunk.dirtyBegin));
+        }
+        target.draw(chunk.vertexBuffer, states);
+    }
+    else {
+        target.draw(chunk.vertices.data(), chunk.vertices.size(), sf::Triangles, states);
+    }
+    chunk.dirtyBegin = 0;
+    chunk.dirtyEnd = 0;
+}
+
 void TileMap::render(sf::RenderTarget& target) {
-    for (const auto& tileData : tileData) {
-        sf::Sprite tileSprite;
-        tileSprite.setTexture(tilesetTexture);
-        tileSprite.setTextureRect(sf::IntRect(tileData.tileIndex * tileSize, 0, tileSize, tileSize));
-        tileSprite.setPosition(tileData.position);
-        target.draw(tileSprite);
-    }
-}
\ No newline at end of file
+    lastDrawCalls = 0;
+    if (mapWidth <= 0 || mapHeight <= 0 || layerCount <= 0)
+        return;
+
+    // World-space bounds of the current view (covers rotated views too)
+    sf::FloatRect visible = target.getView().getInverseTransform().transformRect(sf::FloatRect(-1, -1, 2, 2));
+    float chunkPixels = static_cast<float>(CHUNK_SIZE * tileSize);
+    int firstX = std::max(0, static_cast<int>(std::floor(visible.left / chunkPixels)));
+    int firstY = std::max(0, static_cast<int>(std::floor(visible.top / chunkPixels)));
+    int lastX = std::min(chunksAcross - 1, static_cast<int>(std::floor((visible.left + visible.width) / chunkPixels)));
+    int lastY = std::min(chunksDown - 1, static_cast<int>(std::floor((visible.top + visible.height) / chunkPixels)));
+    if (firstX > lastX || firstY > lastY)
+        return;
+
+    // Never evict a chunk that is needed in the same frame; the extra slots
+    // are given back once the frame is drawn
+    std::size_t visibleChunks = static_cast<std::size_t>(lastX - firstX + 1) * (lastY - firstY + 1);
+    frameChunkLimit = std::max(maxResidentChunks, visibleChunks);
+
+    for (int chunkY = firstY; chunkY <= lastY; ++chunkY) {
+        for (int chunkX = firstX; chunkX <= lastX; ++chunkX) {
+            drawChunk(target, acquireChunk(chunkX, chunkY));
+            ++lastDrawCalls;
+        }
+    }
+
+    frameChunkLimit = maxResidentChunks;
+    trimChunks(maxResidentChunks);
+}
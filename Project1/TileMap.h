@@ -2,24 +2,112 @@
 #define TILEMAP_H
 
 #include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
 #include <vector>
+#include "ResourceCache.h"
 
+class Tileset;
+
+// Tile index at (x, y, layer) for maps too large to store
+typedef std::function<std::uint16_t(int x, int y, int layer)> TileGenerator;
+
+// Chunked tile map renderer.
+// The map is split into CHUNK_SIZE x CHUNK_SIZE chunks whose geometry is
+// built lazily into a static vertex buffer the first time the chunk is
+// visible. Only chunks overlapping the target's view are drawn, one draw
+// call each, and at most maxResidentChunks buffers are kept: the least
+// recently drawn chunk is recycled when a new one is needed.
 class TileMap {
 public:
-    TileMap(const std::string& tilesetFile, int tileSize, int mapWidth, int mapHeight);
+    static const int CHUNK_SIZE = 32;
+    static const std::size_t DEFAULT_MAX_RESIDENT_CHUNKS = 256;
+
+    // Text map, laid out mapWidth tiles per row
+    TileMap(ResourceCache& resources, const std::string& tilesetFile, const std::string& textMapFile, int tileSize, int mapWidth, int mapHeight);
+    // Binary map (see MapFile.h); dimensions, layers and tile size come from its header
+    TileMap(ResourceCache& resources, const std::string& tilesetFile, const std::string& binaryMapFile);
+    // Read-only generated map; no tile storage, only resident chunk geometry
+    TileMap(ResourceCache& resources, const std::string& tilesetFile, int tileSize, int mapWidth, int mapHeight, int layers, TileGenerator generator);
+    // Blank map for a tileset description, every tile set to the tileset's empty tile
+    TileMap(ResourceCache& resources, const Tileset& tileset, int mapWidth, int mapHeight, int layers);
     ~TileMap();
+    // False when the tileset or map could not be loaded; such a map is empty and draws nothing
+    bool isLoaded() const { return loaded; }
     void update(float deltaTime);
     void render(sf::RenderTarget& target);
 
+    // Change one tile; only its quad is re-uploaded on the next render (stored maps only)
+    void setTile(int x, int y, std::uint16_t tileIndex, int layer = 0);
+    std::uint16_t getTile(int x, int y, int layer = 0) const;
+    // Replace a whole layer (mapWidth * mapHeight indices, row-major); resident chunks are rebuilt
+    void setLayer(int layer, const std::vector<std::uint16_t>& layerTiles);
+    int getWidth() const { return mapWidth; }
+    int getHeight() const { return mapHeight; }
+    int getLayerCount() const { return layerCount; }
+
+    // Cap on chunk buffers kept alive; a view that needs more overshoots it for that frame only
+    void setMaxResidentChunks(std::size_t count);
+    std::size_t getResidentChunkCount() const { return chunkSlotOf.size(); }
+    std::size_t getLastDrawCalls() const { return lastDrawCalls; }
+    std::uint64_t getChunkBuildCount() const { return chunkBuilds; }
+
 private:
-    struct TileData {
-        int tileIndex;
-        sf::Vector2f position;
+    struct Chunk {
+        std::uint64_t key;
+        int chunkX;
+        int chunkY;
+        int width;  // In tiles; edge chunks may be smaller than CHUNK_SIZE
+        int height;
+        std::vector<sf::Vertex> vertices;
+        sf::VertexBuffer vertexBuffer;
+        bool useVertexBuffer;
+        std::size_t dirtyBegin; // Vertex range changed since the last upload
+        std::size_t dirtyEnd;
+        int lruPrev; // Neighbours in the recently-drawn list, -1 at the ends
+        int lruNext;
     };
 
-    sf::Texture tilesetTexture;
+    bool loadTileset(ResourceCache& resources, const std::string& tilesetFile);
+    void clear();
+    std::size_t tileOffset(int x, int y, int layer) const {
+        return (static_cast<std::size_t>(layer) * mapHeight + y) * mapWidth + x;
+    }
+    std::uint64_t chunkKey(int chunkX, int chunkY) const {
+        return static_cast<std::uint64_t>(chunkY) * static_cast<std::uint64_t>(chunksAcross) + static_cast<std::uint64_t>(chunkX);
+    }
+
+    Chunk& acquireChunk(int chunkX, int chunkY);
+    void buildChunk(Chunk& chunk);
+    void writeQuad(Chunk& chunk, int x, int y, int layer);
+    void drawChunk(sf::RenderTarget& target, Chunk& chunk);
+    void lruUnlink(int slot);
+    void lruPushFront(int slot);
+    void trimChunks(std::size_t limit);
+
+    TextureHandle tilesetTexture; // Shared through the resource cache
     int tileSize;
-    std::vector<TileData> tileData;
+    int mapWidth;
+    int mapHeight;
+    int layerCount;
+    int chunksAcross;
+    int chunksDown;
+    std::vector<std::uint16_t> tiles; // Tile indices, layer by layer, row-major (empty for generated maps)
+    TileGenerator generator;
+
+    // Resident chunk geometry; slots are recycled least-recently-drawn first
+    std::vector<std::unique_ptr<Chunk>> chunkSlots;
+    std::unordered_map<std::uint64_t, int> chunkSlotOf;
+    std::size_t maxResidentChunks;
+    std::size_t frameChunkLimit; // maxResidentChunks, or the visible chunk count while rendering a larger view
+    int lruHead;
+    int lruTail;
+
+    std::size_t lastDrawCalls;
+    std::uint64_t chunkBuilds;
+    bool loaded;
 };
 
-#endif // TILEMAP_H
\ No newline at end of file
+#endif // TILEMAP_H
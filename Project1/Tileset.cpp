@@ -0,0 +1,109 @@
+#include "Tileset.h"
+#include <SFML/Graphics/Image.hpp>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <iostream>
+
+namespace {
+
+std::string directoryOf(const std::string& path) {
+    std::size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+} // namespace
+
+Tileset::Tileset()
+    : tileSize(0), columns(0), emptyTile(0) {
+    for (int mask = 0; mask < 256; ++mask)
+        maskToTile[mask] = 0;
+}
+
+std::uint8_t Tileset::reduceMask(std::uint8_t mask) {
+    if (!(mask & NEIGHBOUR_N) || !(mask & NEIGHBOUR_E))
+        mask &= ~NEIGHBOUR_NE;
+    if (!(mask & NEIGHBOUR_S) || !(mask & NEIGHBOUR_E))
+        mask &= ~NEIGHBOUR_SE;
+    if (!(mask & NEIGHBOUR_S) || !(mask & NEIGHBOUR_W))
+        mask &= ~NEIGHBOUR_SW;
+    if (!(mask & NEIGHBOUR_N) || !(mask & NEIGHBOUR_W))
+        mask &= ~NEIGHBOUR_NW;
+    return mask;
+}
+
+bool Tileset::loadFromFile(const std::string& descriptionFile) {
+    std::ifstream description(descriptionFile);
+    if (!description.is_open()) {
+        std::cerr << "Failed to open tileset description: " << descriptionFile << std::endl;
+        return false;
+    }
+
+    // Masks are stored by (column, row) until the tile size and texture width are known
+    struct MaskEntry {
+        int mask;
+        int column;
+        int row;
+    };
+    std::vector<MaskEntry> entries;
+    int emptyColumn = 0, emptyRow = 0;
+
+    std::string line;
+    while (std::getline(description, line)) {
+        std::istringstream iss(line);
+        std::string keyword;
+        if (!(iss >> keyword) || keyword[0] == '#')
+            continue;
+
+        bool ok = true;
+        if (keyword == "texture") {
+            std::string file;
+            ok = static_cast<bool>(iss >> file);
+            texturePath = directoryOf(descriptionFile) + file;
+        }
+        else if (keyword == "tileSize") {
+            ok = static_cast<bool>(iss >> tileSize) && tileSize > 0;
+        }
+        else if (keyword == "empty") {
+            ok = static_cast<bool>(iss >> emptyColumn >> emptyRow);
+        }
+        else if (keyword == "mask") {
+            MaskEntry entry;
+            ok = (iss >> entry.mask >> entry.column >> entry.row) && entry.mask >= 0 && entry.mask < 256;
+            // Lookups reduce first, so a corner without both its edges could never be used
+            if (ok && reduceMask(static_cast<std::uint8_t>(entry.mask)) != entry.mask) {
+                std::cerr << "Tileset mask " << entry.mask << " in " << descriptionFile << " sets a corner without both of its edges; use "
+                          << static_cast<int>(reduceMask(static_cast<std::uint8_t>(entry.mask))) << std::endl;
+                return false;
+            }
+            entries.push_back(entry);
+        }
+        if (!ok) {
+            std::cerr << "Malformed tileset line in " << descriptionFile << ": " << line << std::endl;
+            return false;
+        }
+    }
+
+    // The sheet is decoded here only for its width, to learn how many tiles fit in a row
+    sf::Image image;
+    if (texturePath.empty() || tileSize == 0 || !image.loadFromFile(texturePath)) {
+        std::cerr << "Tileset " << descriptionFile << " needs a loadable texture and a tile size" << std::endl;
+        return false;
+    }
+    columns = static_cast<int>(image.getSize().x) / tileSize;
+
+    emptyTile = static_cast<std::uint16_t>(emptyRow * columns + emptyColumn);
+    std::uint16_t reduced[256];
+    bool known[256] = {};
+    for (const MaskEntry& entry : entries) {
+        reduced[entry.mask] = static_cast<std::uint16_t>(entry.row * columns + entry.column);
+        known[entry.mask] = true;
+    }
+
+    // Resolve every raw neighbourhood once so lookups never reduce at runtime
+    for (int mask = 0; mask < 256; ++mask) {
+        std::uint8_t key = reduceMask(static_cast<std::uint8_t>(mask));
+        maskToTile[mask] = known[key] ? reduced[key] : emptyTile;
+    }
+    return true;
+}
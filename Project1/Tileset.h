@@ -0,0 +1,47 @@
+#ifndef TILESET_H
+#define TILESET_H
+
+#include <cstdint>
+#include <string>
+
+// Neighbour bits of an autotile mask
+const std::uint8_t NEIGHBOUR_N = 1 << 0;
+const std::uint8_t NEIGHBOUR_NE = 1 << 1;
+const std::uint8_t NEIGHBOUR_E = 1 << 2;
+const std::uint8_t NEIGHBOUR_SE = 1 << 3;
+const std::uint8_t NEIGHBOUR_S = 1 << 4;
+const std::uint8_t NEIGHBOUR_SW = 1 << 5;
+const std::uint8_t NEIGHBOUR_W = 1 << 6;
+const std::uint8_t NEIGHBOUR_NW = 1 << 7;
+
+// Tileset description loaded from a .tileset file:
+//   texture <image, relative to the description>
+//   tileSize <pixels>
+//   empty <column> <row>          tile used where the terrain is absent
+//   mask <bitmask> <column> <row> tile for a cell whose 8-neighbour mask matches
+// Corner bits only count when both adjacent edges are set, so the 47 masks
+// of a blob layout cover every neighbourhood. The full 256-entry lookup is
+// resolved once at load time.
+class Tileset {
+public:
+    Tileset();
+
+    bool loadFromFile(const std::string& descriptionFile);
+
+    const std::string& getTexturePath() const { return texturePath; }
+    int getTileSize() const { return tileSize; }
+    std::uint16_t getEmptyTile() const { return emptyTile; }
+    std::uint16_t tileForMask(std::uint8_t mask) const { return maskToTile[mask]; }
+
+    // Drop corner bits whose adjacent edges are not both set
+    static std::uint8_t reduceMask(std::uint8_t mask);
+
+private:
+    std::string texturePath;
+    int tileSize;
+    int columns;
+    std::uint16_t emptyTile;
+    std::uint16_t maskToTile[256];
+};
+
+#endif // TILESET_H
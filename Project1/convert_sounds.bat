@@ -0,0 +1,6 @@
+@echo off
+rem SFML 2.6 cannot decode MP3, so sound effects are converted to 16-bit PCM WAV
+rem once, offline. Needs ffmpeg on the PATH; run from the Project1 folder.
+
+ffmpeg -hide_banner -loglevel error -y -i assets\game-bonus-144751.mp3 -ac 1 -ar 44100 -c:a pcm_s16le assets\bonus.wav || exit /b 1
+echo Wrote assets\bonus.wav
@@ -3,429 +3,721 @@
 #include <iostream>
 #include <cstdlib>
 #include <ctime>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <fstream>
 #include "TileMap.h"
+#include "GameSim.h"
+#include "SpriteBatch.h"
+#include "TextureAtlas.h"
+#include "Hud.h"
+#include "Menu.h"
+#include "MapFile.h"
+#include "AssetLoader.h"
+#include "ResourceCache.h"
+#include "AssetPack.h"
+#include "Profiler.h"
+#include "ProfilerOverlay.h"
+#include "InputRecording.h"
+#include "Leaderboard.h"
+#include "LeaderboardServer.h"
+#include "LeaderboardClient.h"
+#include "LeaderboardLoad.h"
+#include "NetServer.h"
+#include "NetClient.h"
+#include "NetBots.h"
+#include "SpectatorRelay.h"
+#include "SpectatorBench.h"
+#include "SoundPool.h"
+
+// Prebuilt atlas written by "Project1 --build-atlas"
+const char* ATLAS_MANIFEST = "assets/atlas.txt";
+
+// Archive written by "Project1 --build-pack"; loose files are used when it is missing
+const char* PACK_FILE = "assets/assets.pak";
+const char* FONT_FILE = "arial.ttf";
+
+// Written by convert_sounds.bat from the bundled MP3, which SFML cannot decode
+const char* BONUS_SOUND_FILE = "assets/bonus.wav";
+
+// Every finished run, ranked; written by a background thread
+const char* LEADERBOARD_FILE = "leaderboard.log";
+const char* PLAYER_NAME = "Player";
+
+// Full-screen background, streamed in after the first frame rather than packed into the atlas
+const char* BACKGROUND_FILE = "assets/tree.png";
+
+// Sprites packed into the texture atlas
+std::vector<AtlasSource> atlasSources() {
+    return {
+        { "apple", "assets/apple.png", true },
+        { "bomb", "assets/bomb.png", true },
+        { "banana", "assets/banana.png", true },
+        { "watermelon", "assets/watermelon.png", true },
+        { "collectible_object_level1", "assets/collectible_object_level1.png", true },
+        { "cursor", "assets/cursor.png", true },
+        // Frame strips are indexed by position, so they keep their borders
+        { "player_spritesheet", "assets/player_spritesheet.png", false },
+        { "IDLE", "assets/IDLE.png", false },
+        { "RUN", "assets/RUN.png", false },
+    };
+}
 
-// Define constants
-const int WINDOW_WIDTH = 1920;
-const int WINDOW_HEIGHT = 1080;
-const float PLAYER_SPEED = 900.0f;
-const float ITEM_SPEED = 200.0f;
-const int NUM_BOMBS = 2;
-const float FRUIT_SPAWN_INTERVAL = 0.4f;
-const float BOMB_SPAWN_INTERVAL = 1.5f;
-const int SCORE_PER_FRUIT = 10;
-const float PLAYER_WIDTH = 150.0f;
-const float PLAYER_HEIGHT = 350.0f;
-const float COLLISION_REDUCTION = 10.0f;
-
-// Define constants for animation
-const int FRAME_WIDTH = 24; // Width of each frame
-const int FRAME_HEIGHT = 24; // Height of each frame
-const int NUM_FRAMES = 3; // Number of frames in the animation (neutral, left, right)
-
-// Player class
-class Player {
-public:
-    sf::Sprite sprite;
-    sf::Vector2f velocity;
-    int currentFrame; // Current frame index for animation
-
-    Player(sf::Texture& texture) : currentFrame(0) {
-        sprite.setTexture(texture);
-        sprite.setScale(1.5f, 1.5f);
-        // Set initial texture rectangle to display the neutral frame
-        sprite.setTextureRect(sf::IntRect(FRAME_WIDTH, 0, FRAME_WIDTH, FRAME_HEIGHT));
-        // Adjust starting position to the bottom of the window
-        sprite.setPosition((WINDOW_WIDTH - PLAYER_WIDTH) / 2, WINDOW_HEIGHT - PLAYER_HEIGHT);
+// Everything the game loads at startup, by the name it is loaded under
+std::vector<PackSource> packSources() {
+    std::vector<PackSource> sources;
+    for (const std::string& file : TextureAtlas::manifestFiles(ATLAS_MANIFEST))
+        sources.push_back({ file, file });
+    sources.push_back({ BACKGROUND_FILE, BACKGROUND_FILE });
+    sources.push_back({ FONT_FILE, FONT_FILE });
+    // Only once it has been converted
+    if (std::ifstream(BONUS_SOUND_FILE))
+        sources.push_back({ BONUS_SOUND_FILE, BONUS_SOUND_FILE });
+    return sources;
+}
+
+// Decode the prebuilt atlas, or pack the loose sprites when there is none.
+// CPU only, so it runs on an asset loader worker; upload() follows on the render thread.
+bool decodeAtlas(TextureAtlas& atlas, const AssetPack* pack) {
+    if (atlas.load(ATLAS_MANIFEST, pack))
+        return true;
+    std::cout << "No atlas manifest at " << ATLAS_MANIFEST << ", packing sprites at startup" << std::endl;
+    return atlas.build(atlasSources());
+}
+
+// Show the frame and stamp the first one on the startup timeline
+void present(sf::RenderWindow& window, AssetLoader& loader, bool& firstFrameShown) {
+    window.display();
+    if (!firstFrameShown) {
+        loader.mark("first frame");
+        firstFrameShown = true;
     }
+}
+
+// Print how much of one core the process used while the pause menu was open
+void reportPauseCpu(double cpuSeconds, sf::Time pausedTime) {
+    if (pausedTime <= sf::Time::Zero)
+        return;
+    std::cout << "Paused for " << pausedTime.asSeconds() << " s, using "
+              << 100.0 * cpuSeconds / pausedTime.asSeconds() << "% of one core" << std::endl;
+}
 
-    void update(float deltaTime) {
-        // Update player position while keeping it within bounds
-        sf::Vector2f nextPosition = sprite.getPosition() + velocity * deltaTime;
-        nextPosition.x = std::max(0.0f, std::min(WINDOW_WIDTH - PLAYER_WIDTH, nextPosition.x));
-        nextPosition.y = std::max(0.0f, std::min(WINDOW_HEIGHT - PLAYER_HEIGHT, nextPosition.y));
-        sprite.setPosition(nextPosition);
+// Look up a region the game cannot run without
+const AtlasRegion* requireRegion(const TextureAtlas& atlas, const std::string& name) {
+    const AtlasRegion* region = atlas.find(name);
+    if (!region)
+        std::cerr << "Texture atlas has no region named " << name << std::endl;
+    return region;
+}
 
-        // Update animation frame based on velocity
-        if (velocity.x < 0) {
-            currentFrame = 17; // Left animation frame
-        }
-        else if (velocity.x > 0) {
-            currentFrame = 18; // Right animation frame
+// Queue an atlas region where its untrimmed source image would be drawn
+void drawRegion(SpriteBatch& batch, const TextureAtlas& atlas, const AtlasRegion& region, float posX, float posY, float scale = 1.0f) {
+    batch.draw(atlas.pageTexture(region.page), region.rect, posX + region.offset.x * scale, posY + region.offset.y * scale, scale, scale);
+}
+
+// Blend between the previous and current simulation tick
+inline float interpolate(float previous, float current, float alpha) {
+    return previous + (current - previous) * alpha;
+}
+
+// Build the simulation config from the item sprites (collision uses the untrimmed size)
+GameSimConfig makeSimConfig(const AtlasRegion& appleRegion, const AtlasRegion& bombRegion) {
+    GameSimConfig config = GameSim::defaultConfig();
+    ItemKindInfo& apple = config.itemKinds[static_cast<int>(ItemKind::Apple)];
+    apple.width = static_cast<float>(appleRegion.sourceSize.x);
+    apple.height = static_cast<float>(appleRegion.sourceSize.y);
+    ItemKindInfo& bomb = config.itemKinds[static_cast<int>(ItemKind::Bomb)];
+    bomb.width = static_cast<float>(bombRegion.sourceSize.x);
+    bomb.height = static_cast<float>(bombRegion.sourceSize.y);
+    config.seed = static_cast<std::uint32_t>(std::time(nullptr));
+    return config;
+}
+
+// Plays a collect sound for each fruit picked up and a bomb sound when the
+// run ends. Both are worked out from the score and game-over state once a
+// frame, so local and networked play share it. The bomb is the bonus sample
+// an octave down and outranks the collects when voices run short.
+class GameSounds {
+public:
+    GameSounds()
+        : collect(NO_SOUND_EFFECT),
+          bomb(NO_SOUND_EFFECT),
+          lastScore(0),
+          wasOut(false),
+          collects(0) {
+    }
+
+    // The game runs silent without the converted sample
+    void load(ResourceCache& resources) {
+        if (!std::ifstream(BONUS_SOUND_FILE)) {
+            std::cout << "No " << BONUS_SOUND_FILE << "; run convert_sounds.bat for sound effects" << std::endl;
+            return;
         }
-        else {
-            currentFrame = 0; // Neutral frame
+        SoundBufferHandle bonus = resources.getSoundBuffer(BONUS_SOUND_FILE);
+        collect = pool.addEffect(bonus, 1, 8);
+        bomb = pool.addEffect(bonus, 10, 2);
+    }
+
+    void update(int score, bool out) {
+        // A lower score is a new round, not a penalty
+        for (int points = score - lastScore; points >= SCORE_PER_FRUIT; points -= SCORE_PER_FRUIT) {
+            // Step the pitch so a burst of pickups does not sound like one
+            pool.play(collect, 60.0f, 1.0f + 0.06f * (collects++ % 4));
         }
-        // Update texture rectangle for animation
-        sprite.setTextureRect(sf::IntRect(currentFrame * FRAME_WIDTH, 0, FRAME_WIDTH, FRAME_HEIGHT));
+        if (out && !wasOut)
+            pool.play(bomb, 100.0f, 0.5f);
+        lastScore = score;
+        wasOut = out;
+        pool.update();
     }
+
+private:
+    SoundPool pool;
+    SoundEffectId collect;
+    SoundEffectId bomb;
+    int lastScore;
+    bool wasOut;
+    unsigned int collects;
 };
 
-// Texture loading function
-void loadPlayerTexture(sf::Texture& texture) {
-    if (!texture.loadFromFile("assets/player_spritesheet.png")) {
-        std::cerr << "Failed to load player_spritesheet.png" << std::endl;
-        exit(1);
+// Run the simulation without a window, one profiler frame per tick, streamed to a CSV file
+int runHeadless(long ticks, const std::string& csvFile) {
+    std::ofstream csv(csvFile);
+    if (!csv.is_open()) {
+        std::cerr << "Failed to write profile: " << csvFile << std::endl;
+        return 1;
     }
+    Profiler::instance().setCsvSink(&csv);
+
+    GameSim sim(GameSim::defaultConfig());
+    InputState input;
+    for (long tick = 0; tick < ticks; ++tick) {
+        PROFILE_FRAME_BEGIN();
+        {
+            PROFILE_SCOPE(ProfilePhase::Input);
+            // Sweep across the screen, turning every two seconds
+            input.left = (tick / (2 * SIM_TICK_RATE)) % 2 == 0;
+            input.right = !input.left;
+        }
+        sim.step(SIM_TICK, input);
+        if (sim.isGameOver())
+            sim.reset();
+        PROFILE_FRAME_END();
+    }
+
+    Profiler::instance().setCsvSink(nullptr);
+    std::cout << "Profiled " << ticks << " ticks into " << csvFile << std::endl;
+    return 0;
 }
 
-// Function to load tree texture
-void loadTreeTexture(sf::Texture& texture) {
-    if (!texture.loadFromFile("assets/tree.png")) {
-        std::cerr << "Failed to load tree.png" << std::endl;
-        exit(1);
+// Re-run a recorded session as fast as possible and report where the time went
+int runReplay(const std::string& recordingFile, const std::string& csvFile) {
+    InputReplay replay;
+    if (!replay.open(recordingFile))
+        return 1;
+
+    std::ofstream csv;
+    if (!csvFile.empty()) {
+        csv.open(csvFile);
+        if (!csv.is_open()) {
+            std::cerr << "Failed to write profile: " << csvFile << std::endl;
+            return 1;
+        }
+        Profiler::instance().setCsvSink(&csv);
     }
-}
 
-// Item class (base class for fruits and bombs)
-class Item {
-public:
-    sf::Sprite sprite;
-    int points;
-    bool collected;
-
-    Item(sf::Texture& texture, float posX, float posY, int points) {
-        sprite.setTexture(texture);
-        sprite.setPosition(posX, posY);
-        this->points = points;
-        collected = false;
+    GameSim sim(replay.config());
+    ProfileSummary summary;
+    std::uint64_t ticks = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const ReplayRun& run : replay.runs()) {
+        if (run.flags & REPLAY_RESET) {
+            sim.reset();
+            continue;
+        }
+        InputState input = InputReplay::input(run);
+        for (std::uint32_t tick = 0; tick < run.ticks; ++tick) {
+            PROFILE_FRAME_BEGIN();
+            sim.step(SIM_TICK, input);
+            PROFILE_FRAME_END();
+#if PROFILER_ENABLED
+            summary.add(Profiler::instance().frame(0));
+#endif
+        }
+        ticks += run.ticks;
     }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    Profiler::instance().setCsvSink(nullptr);
 
-    virtual void update(float deltaTime) {
-        if (!collected)
-            sprite.move(0, ITEM_SPEED * deltaTime);
+    const ReplayHeader& header = replay.header();
+    std::cout << "Replayed " << ticks << " ticks (" << ticks / static_cast<double>(SIM_TICK_RATE) << " s of play, seed "
+              << header.seed << ") in " << elapsed.count() << " s" << std::endl;
+    summary.print(std::cout, static_cast<float>(SIM_TICK_RATE));
+
+    if (!header.complete) {
+        std::cout << "Recording was not closed; the final state cannot be checked" << std::endl;
     }
+    else if (ticks != header.totalTicks || sim.checksum() != header.finalChecksum) {
+        std::cerr << "Replay diverged from the recording (checksum " << sim.checksum() << ", recorded " << header.finalChecksum << ")" << std::endl;
+        return 1;
+    }
+    return 0;
+}
 
-    virtual sf::FloatRect getCollisionBounds() const {
-        // By default, use the sprite's global bounds for collision detection
-        return sprite.getGlobalBounds();
+int main(int argc, char* argv[]) {
+    // Offline atlas build: pack the loose sprites and write the manifest and pages
+    if (argc > 1 && std::string(argv[1]) == "--build-atlas") {
+        TextureAtlas atlas;
+        return atlas.build(atlasSources()) && atlas.save(ATLAS_MANIFEST) ? 0 : 1;
     }
-};
 
-// Fruit classes
-class Apple : public Item {
-public:
-    Apple(sf::Texture& texture, float posX, float posY)
-        : Item(texture, posX, posY, SCORE_PER_FRUIT) {} // Apple worth SCORE_PER_FRUIT points
-};
+    // Offline asset packing; --raw stores images as decoded RGBA so startup skips PNG/JPEG decoding
+    if (argc > 1 && std::string(argv[1]) == "--build-pack") {
+        if (TextureAtlas::manifestFiles(ATLAS_MANIFEST).empty()) {
+            std::cerr << "Build the atlas first with --build-atlas" << std::endl;
+            return 1;
+        }
+        bool rawImages = argc > 2 && std::string(argv[2]) == "--raw";
+        return buildPack(packSources(), PACK_FILE, rawImages) ? 0 : 1;
+    }
 
-// Bomb class
-class Bomb : public Item {
-public:
-    Bomb(sf::Texture& texture, float posX, float posY)
-        : Item(texture, posX, posY, -50) {} // Bomb deducts 50 points
-
-    // Override the getCollisionBounds function to adjust bomb collision bounds
-    sf::FloatRect getCollisionBounds() const override {
-        // Adjust collision bounds based on current animation frame
-        sf::FloatRect bounds = sprite.getGlobalBounds();
-        // Reduce bounds by COLLISION_REDUCTION pixels on each side
-        bounds.left += COLLISION_REDUCTION;
-        bounds.width -= 2 * COLLISION_REDUCTION;
-        bounds.top += COLLISION_REDUCTION;
-        bounds.height -= 2 * COLLISION_REDUCTION;
-        return bounds;
+    // Headless profiling run
+    if (argc > 1 && std::string(argv[1]) == "--headless") {
+        if (argc != 4) {
+            std::cerr << "Usage: " << argv[0] << " --headless <ticks> <profile.csv>" << std::endl;
+            return 1;
+        }
+        return runHeadless(std::atol(argv[2]), argv[3]);
     }
-};
 
-void handleEscapeMenu(sf::RenderWindow& window, bool& gamePaused) {
-    sf::Font font;
-    if (!font.loadFromFile("arial.ttf")) {
-        std::cerr << "Failed to load font file" << std::endl;
-        return;
+    // Headless replay of a recorded session, optionally writing every tick's timings
+    if (argc > 1 && std::string(argv[1]) == "--replay") {
+        if (argc != 3 && argc != 4) {
+            std::cerr << "Usage: " << argv[0] << " --replay <recording> [profile.csv]" << std::endl;
+            return 1;
+        }
+        return runReplay(argv[2], argc == 4 ? argv[3] : "");
     }
 
-    // Create a transparent background for the pause menu
-    sf::RectangleShape pauseOverlay(sf::Vector2f(WINDOW_WIDTH, WINDOW_HEIGHT));
-    pauseOverlay.setFillColor(sf::Color(0, 0, 0, 100));
-
-    // Create pause text
-    sf::Text pauseText;
-    pauseText.setFont(font);
-    pauseText.setString("Paused");
-    pauseText.setCharacterSize(48);
-    pauseText.setFillColor(sf::Color::White);
-    pauseText.setPosition(WINDOW_WIDTH / 2 - pauseText.getGlobalBounds().width / 2, WINDOW_HEIGHT / 2 - pauseText.getGlobalBounds().height / 2);
-
-    // Create quit text with some space
-    sf::Text quitText;
-    quitText.setFont(font);
-    quitText.setString("Quit Game (Press Q)");
-    quitText.setCharacterSize(24);
-    quitText.setFillColor(sf::Color::White);
-    quitText.setPosition(WINDOW_WIDTH / 2 - quitText.getGlobalBounds().width / 2, pauseText.getPosition().y + 80); // Adjusted position
-
-    window.draw(pauseOverlay);
-    window.draw(pauseText);
-    window.draw(quitText);
-    window.display();
+    // Shared leaderboard for kiosks; runs until the process is stopped
+    if (argc > 1 && std::string(argv[1]) == "--leaderboard-server") {
+        Leaderboard leaderboard(LEADERBOARD_FILE);
+        LeaderboardServer server(leaderboard);
+        if (!server.listen(argc > 2 ? static_cast<unsigned short>(std::atoi(argv[2])) : LEADERBOARD_PORT))
+            return 1;
+        server.run();
+        return 0;
+    }
 
-    bool paused = true;
-    while (paused) {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed)
-                window.close();
-            else if (event.type == sf::Event::KeyPressed) {
-                if (event.key.code == sf::Keyboard::Q) {
-                    window.close();
-                    return;
-                }
-                else if (event.key.code == sf::Keyboard::Escape) {
-                    paused = false;
-                    gamePaused = false;
-                    return;
-                }
-            }
-        }
+    // Load test against a running leaderboard server
+    if (argc > 1 && std::string(argv[1]) == "--leaderboard-load") {
+        int clients = argc > 2 ? std::atoi(argv[2]) : 1000;
+        float seconds = argc > 3 ? static_cast<float>(std::atof(argv[3])) : 10.0f;
+        sf::IpAddress server(argc > 4 ? argv[4] : "127.0.0.1");
+        unsigned short port = argc > 5 ? static_cast<unsigned short>(std::atoi(argv[5])) : LEADERBOARD_PORT;
+        return runLeaderboardLoad(server, port, clients, seconds);
     }
-}
 
-// Function to handle game over menu
-bool handleGameOverMenu(sf::RenderWindow& window) {
-    sf::Font font;
-    if (!font.loadFromFile("arial.ttf")) {
-        std::cerr << "Failed to load font file" << std::endl;
-        return false;
+    // Authoritative multiplayer server; runs until the process is stopped
+    if (argc > 1 && std::string(argv[1]) == "--net-server") {
+        int players = argc > 2 ? std::atoi(argv[2]) : 8;
+        NetServer server(std::max(1, std::min(players, MAX_SIM_PLAYERS)));
+        if (!server.bind(NET_PORT))
+            return 1;
+        // Spectators watch the same game over TCP
+        SpectatorRelay relay;
+        if (!relay.listen(SPECTATOR_PORT))
+            return 1;
+        server.setSpectatorRelay(&relay);
+        std::thread relayThread([&relay] { relay.run(); });
+        std::cout << "Multiplayer server on UDP port " << NET_PORT << ", spectators on TCP port " << SPECTATOR_PORT << std::endl;
+        server.run();
+        relay.stop();
+        relayThread.join();
+        return 0;
     }
 
-    // Create a transparent background for the game over menu
-    sf::RectangleShape gameOverOverlay(sf::Vector2f(WINDOW_WIDTH, WINDOW_HEIGHT));
-    gameOverOverlay.setFillColor(sf::Color(0, 0, 0, 100));
-
-    // Create game over text
-    sf::Text gameOverText;
-    gameOverText.setFont(font);
-    gameOverText.setString("Oh no... You died.\nWanna play again?");
-    gameOverText.setCharacterSize(36);
-    gameOverText.setFillColor(sf::Color::White);
-    gameOverText.setPosition(WINDOW_WIDTH / 2 - gameOverText.getGlobalBounds().width / 2, WINDOW_HEIGHT / 2 - gameOverText.getGlobalBounds().height / 2 - 40);
-
-    // Create play again text
-    sf::Text playAgainText;
-    playAgainText.setFont(font);
-    playAgainText.setString("Play again (Press R)");
-    playAgainText.setCharacterSize(24);
-    playAgainText.setFillColor(sf::Color::White);
-    playAgainText.setPosition(WINDOW_WIDTH / 2 - playAgainText.getGlobalBounds().width / 2, gameOverText.getPosition().y + 100);
-
-    // Create quit text
-    sf::Text quitText;
-    quitText.setFont(font);
-    quitText.setString("Quit Game (Press Q)");
-    quitText.setCharacterSize(24);
-    quitText.setFillColor(sf::Color::White);
-    quitText.setPosition(WINDOW_WIDTH / 2 - quitText.getGlobalBounds().width / 2, playAgainText.getPosition().y + 60);
-
-    window.draw(gameOverOverlay);
-    window.draw(gameOverText);
-    window.draw(playAgainText);
-    window.draw(quitText);
-    window.display();
+    // Bots against a running multiplayer server, or a scaling benchmark with its own server
+    if (argc > 1 && std::string(argv[1]) == "--net-bots") {
+        int bots = argc > 2 ? std::atoi(argv[2]) : 8;
+        float seconds = argc > 3 ? static_cast<float>(std::atof(argv[3])) : 10.0f;
+        sf::IpAddress server(argc > 4 ? argv[4] : "127.0.0.1");
+        return runNetBots(server, NET_PORT, bots, seconds);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--net-bench")
+        return runNetBench(NET_PORT, argc > 2 ? static_cast<float>(std::atof(argv[2])) : 3.0f);
+
+    // Loopback test of the spectator relay with many viewers
+    if (argc > 1 && std::string(argv[1]) == "--spectator-bench") {
+        int viewers = argc > 2 ? std::atoi(argv[2]) : 1000;
+        float seconds = argc > 3 ? static_cast<float>(std::atof(argv[3])) : 10.0f;
+        return runSpectatorBench(SPECTATOR_PORT, viewers, seconds);
+    }
 
-    while (true) {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed)
-                window.close();
-            else if (event.type == sf::Event::KeyPressed) {
-                if (event.key.code == sf::Keyboard::R)
-                    return true; // Restart game
-                else if (event.key.code == sf::Keyboard::Q)
-                    return false; // Quit game
-            }
+    // Offline map conversion: text rows of tile indices to the binary map format
+    if (argc > 1 && std::string(argv[1]) == "--convert-map") {
+        if (argc != 5) {
+            std::cerr << "Usage: " << argv[0] << " --convert-map <map.txt> <map.bin> <tileSize>" << std::endl;
+            return 1;
         }
+        return convertTextMap(argv[2], argv[3], std::atoi(argv[4])) ? 0 : 1;
+    }
+
+    // Optionally stream every frame's timings to a CSV file for attributing stutter,
+    // and record the session's input so it can be replayed with --replay
+    std::ofstream profileCsv;
+    std::string recordFile;
+    std::string leaderboardServer;
+    unsigned short leaderboardPort = LEADERBOARD_PORT;
+    std::string gameServer;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--profile-csv") {
+            profileCsv.open(argv[i + 1]);
+            if (profileCsv.is_open())
+                Profiler::instance().setCsvSink(&profileCsv);
+            else
+                std::cerr << "Failed to write profile: " << argv[i + 1] << std::endl;
+        }
+        else if (option == "--record") {
+            recordFile = argv[i + 1];
+        }
+        else if (option == "--leaderboard") {
+            leaderboardServer = argv[i + 1];
+        }
+        else if (option == "--leaderboard-port") {
+            leaderboardPort = static_cast<unsigned short>(std::atoi(argv[i + 1]));
+        }
+        else if (option == "--connect") {
+            gameServer = argv[i + 1];
+        }
+    }
+
+    // Owns every texture and font; declared first so it outlives their users.
+    // The atlas is declared before the loader so its workers are joined before the atlas goes away
+    ResourceCache resources;
+    TextureAtlas atlas;
+    AssetLoader loader(resources);
+    const sf::Time uploadBudget = sf::seconds(ASSET_UPLOAD_BUDGET);
+
+    // Mapped, not read: only the pages loaders touch come off the disk
+    std::shared_ptr<AssetPack> pack = std::make_shared<AssetPack>();
+    if (pack->open(PACK_FILE)) {
+        resources.mountPack(pack);
+        loader.mark("mounted " + std::string(PACK_FILE));
     }
-}
 
-int main() {
+    // Runs go to the shared server when one is given, otherwise to the local log.
+    // Either way submitting only queues the run for a background thread
+    std::unique_ptr<LeaderboardClient> remoteLeaderboard;
+    std::unique_ptr<Leaderboard> localLeaderboard;
+    if (!leaderboardServer.empty())
+        remoteLeaderboard.reset(new LeaderboardClient(sf::IpAddress(leaderboardServer), leaderboardPort));
+    else
+        localLeaderboard.reset(new Leaderboard(LEADERBOARD_FILE)); // Rebuilds its index on its own thread
+
+    // With a multiplayer server the local simulation stays idle and the
+    // scene comes from the server's snapshots instead
+    NetClient netClient;
+    NetView netView;
+    bool networked = !gameServer.empty();
+    if (networked && !netClient.connect(sf::IpAddress(gameServer)))
+        return 1;
+
     // Get desktop resolution
     sf::VideoMode desktopMode = sf::VideoMode::getDesktopMode();
     // Create a fullscreen window with desktop resolution
     sf::RenderWindow window(sf::VideoMode(desktopMode.width, desktopMode.height), "Fruit Picker", sf::Style::Fullscreen);
+    // Present at the display rate instead of spinning; the simulation rate is fixed separately
+    window.setVerticalSyncEnabled(true);
+    loader.mark("window opened");
+
+    // Decode the sprites on workers while the window is already presenting
+    std::future<bool> atlasDecoded = loader.run("atlas decode", [&atlas, &resources] { return decodeAtlas(atlas, resources.getPack().get()); });
+    AssetHandle background = loader.loadTexture(BACKGROUND_FILE);
 
-    // Load textures
-    sf::Texture appleTexture;
-    if (!appleTexture.loadFromFile("assets/apple.png")) {
-        std::cerr << "Failed to load apple.png" << std::endl;
+    // Score display; the font is opened once here, not per frame
+    Hud hud;
+    if (!hud.load(resources, FONT_FILE, 24))
         return 1;
+    hud.setPosition(10, 10);
+
+    // Loading, pause and game-over overlays share the HUD font
+    Menu menu(hud.getFont());
+
+    // Sound buffers are loaded once here; playing only reuses the pool's voices
+    GameSounds sounds;
+    sounds.load(resources);
+    bool firstFrameShown = false;
+
+    // Loading screen until the atlas is decoded; the background may still be streaming
+    while (atlasDecoded.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        sf::Event event;
+        while (window.pollEvent(event)) {
+            if (event.type == sf::Event::Closed)
+                return 0;
+        }
+        loader.update(uploadBudget);
+        window.clear();
+        menu.draw(window, GameState::Loading);
+        present(window, loader, firstFrameShown);
     }
+    if (!atlasDecoded.get() || !atlas.upload(resources, ATLAS_MANIFEST))
+        return 1;
+    loader.mark("atlas uploaded");
 
-    sf::Texture bombTexture;
-    if (!bombTexture.loadFromFile("assets/bomb.png")) {
-        std::cerr << "Failed to load bomb.png" << std::endl;
+    const AtlasRegion* appleRegion = requireRegion(atlas, "apple");
+    const AtlasRegion* bombRegion = requireRegion(atlas, "bomb");
+    const AtlasRegion* playerRegion = requireRegion(atlas, "player_spritesheet");
+    if (!appleRegion || !bombRegion || !playerRegion)
         return 1;
-    }
 
-    sf::Texture playerTexture;
-    loadPlayerTexture(playerTexture); // Load player sprite sheet
-    // Ensure that the player texture dimensions are divisible by the frame dimensions
-    if (playerTexture.getSize().x % FRAME_WIDTH != 0 || playerTexture.getSize().y != FRAME_HEIGHT) {
+    // Ensure that the player sprite sheet dimensions are divisible by the frame dimensions
+    if (playerRegion->sourceSize.x % FRAME_WIDTH != 0 || playerRegion->sourceSize.y != FRAME_HEIGHT) {
         std::cerr << "Player sprite sheet dimensions are invalid" << std::endl;
         return 1;
     }
 
-    sf::Texture treeTexture;
-    loadTreeTexture(treeTexture); // Load tree texture
+    // All gameplay runs in the headless simulation; this loop only feeds it input and draws it
+    GameSimConfig simConfig = makeSimConfig(*appleRegion, *bombRegion);
+    GameSim sim(simConfig);
 
-    // Create player
-    Player player(playerTexture);
+    // Seed, config and every tick's input; enough to reproduce the session exactly
+    InputRecorder recorder;
+    if (!recordFile.empty() && !networked)
+        recorder.open(recordFile, simConfig);
 
-    // Create the middle tree
-    sf::Sprite middleTree;
-    middleTree.setTexture(treeTexture);
-    middleTree.setPosition((WINDOW_WIDTH - middleTree.getGlobalBounds().width) / 2, 0);
+    // Atlas region of each item kind
+    const AtlasRegion* itemRegions[static_cast<int>(ItemKind::Count)];
+    itemRegions[static_cast<int>(ItemKind::Apple)] = appleRegion;
+    itemRegions[static_cast<int>(ItemKind::Bomb)] = bombRegion;
 
-    // Create vectors for items and bombs
-    std::vector<Item*> items;
-    std::vector<Bomb> bombs;
+    // Tree, player and items are drawn through one batch, one draw call per texture
+    SpriteBatch spriteBatch;
 
-    int score = 0;
+    // Per-phase frame timings, toggled with F3
+    ProfilerOverlay profilerOverlay(hud.getFont());
+    bool timelinePrinted = false;
 
-    bool gamePaused = false;
+    GameState state = GameState::Playing;
+    // Rank of the last finished run, filled in when the leaderboard has written it
+    std::future<std::uint64_t> pendingRank;
+    const sf::Time menuFrameTime = sf::seconds(1.0f / MENU_FRAME_RATE);
 
     // Game loop
     sf::Clock clock;
-    float timeSinceLastFruitSpawn = 0.0f;
-    float timeSinceLastBombSpawn = 0.0f;
-    bool gameOver = false;
+    sf::Clock menuClock;
+    float accumulator = 0.0f;
+    // Process CPU time and wall time since the game was last paused
+    double pauseCpuStart = 0.0;
+    sf::Clock pauseClock;
 
     while (window.isOpen()) {
-        sf::Time deltaTime = clock.restart();
-        float dtSeconds = deltaTime.asSeconds();
+        PROFILE_FRAME_BEGIN();
 
         // Handle events
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed)
-                window.close();
-            else if (event.type == sf::Event::KeyPressed) {
-                if (event.key.code == sf::Keyboard::Escape && !gamePaused) {
-                    gamePaused = true;
-                    handleEscapeMenu(window, gamePaused);
+        {
+            PROFILE_SCOPE(ProfilePhase::Events);
+            sf::Event event;
+            while (window.pollEvent(event)) {
+                if (event.type == sf::Event::Closed)
+                    window.close();
+                else if (event.type == sf::Event::KeyPressed) {
+                    sf::Keyboard::Key key = event.key.code;
+                    if (state == GameState::Playing && key == sf::Keyboard::Escape) {
+                        state = GameState::Paused;
+                        pauseCpuStart = processCpuSeconds();
+                        pauseClock.restart();
+                    }
+                    else if (state == GameState::Paused && key == sf::Keyboard::Escape) {
+                        // Time spent in the menu is not simulated
+                        reportPauseCpu(processCpuSeconds() - pauseCpuStart, pauseClock.getElapsedTime());
+                        state = GameState::Playing;
+                        clock.restart();
+                    }
+                    else if (state == GameState::GameOver && key == sf::Keyboard::R && !networked) {
+                        // Restart game (O(1) pool reset); a natural point to drop unused resources
+                        sim.reset();
+                        recorder.recordReset();
+                        menu.clearRank();
+                        pendingRank = std::future<std::uint64_t>();
+                        resources.evictUnused(RESOURCE_MEMORY_BUDGET);
+                        state = GameState::Playing;
+                        clock.restart();
+                        accumulator = 0.0f;
+                    }
+                    else if (state != GameState::Playing && key == sf::Keyboard::Q) {
+                        // Quit game
+                        window.close();
+                    }
+                    else if (key == sf::Keyboard::F3) {
+                        profilerOverlay.toggle();
+                    }
                 }
             }
         }
+        if (!window.isOpen())
+            break;
+        if (networked && !netClient.isConnected()) {
+            window.close();
+            break;
+        }
 
-        if (!gamePaused && !gameOver) {
-            // Player movement
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::A))
-                player.velocity.x = -PLAYER_SPEED;
-            else if (sf::Keyboard::isKeyPressed(sf::Keyboard::D))
-                player.velocity.x = PLAYER_SPEED;
-            else
-                player.velocity.x = 0;
-
-            // Update player
-            player.update(dtSeconds);
-
-            // Spawn fruits from the top with random X positions across multiple lines
-            timeSinceLastFruitSpawn += dtSeconds;
-            if (timeSinceLastFruitSpawn > FRUIT_SPAWN_INTERVAL) {
-                for (int i = 0; i < 2; ++i) { // Reduce the number of lines
-                    float posX = std::rand() % (WINDOW_WIDTH - 200) + 100; // Random X position across the screen (avoiding edges)
-                    float posY = 50 * (i + 1); // Start above the screen, increment Y for each line
-                    items.push_back(new Apple(appleTexture, posX, posY));
-                }
-                timeSinceLastFruitSpawn = 0.0f;
+        if (state == GameState::Playing) {
+            float frameTime = clock.restart().asSeconds();
+
+            InputState input;
+            {
+                PROFILE_SCOPE(ProfilePhase::Input);
+                input.left = sf::Keyboard::isKeyPressed(sf::Keyboard::A);
+                input.right = sf::Keyboard::isKeyPressed(sf::Keyboard::D);
             }
 
-            // Spawn bombs from the top with random X positions across multiple lines
-            timeSinceLastBombSpawn += dtSeconds;
-            if (timeSinceLastBombSpawn > BOMB_SPAWN_INTERVAL) {
-                for (int i = 0; i < 2; ++i) { // Reduce the number of lines
-                    float posX = std::rand() % (WINDOW_WIDTH - 200) + 100; // Random X position across the screen (avoiding edges)
-                    float posY = 50 * (i + 1); // Start above the screen, increment Y for each line
-                    bombs.push_back(Bomb(bombTexture, posX, posY));
+            if (networked) {
+                // The server simulates; a run ends when it has this player out
+                netClient.update(input);
+                if (netClient.view(frameTime, netView) && netView.players[netClient.getSlot()].out) {
+                    state = GameState::GameOver;
+                    int score = netView.players[netClient.getSlot()].score;
+                    pendingRank = remoteLeaderboard ? remoteLeaderboard->submit(PLAYER_NAME, score) : localLeaderboard->submit(PLAYER_NAME, score);
                 }
-                timeSinceLastBombSpawn = 0.0f;
             }
+            else {
+                // Run whole fixed ticks for the elapsed time, capped to avoid a spiral of death
+                accumulator += frameTime;
+                int steps = 0;
+                while (accumulator >= SIM_TICK && steps < MAX_SIM_STEPS_PER_FRAME && !sim.isGameOver()) {
+                    recorder.recordTick(input);
+                    sim.step(SIM_TICK, input);
+                    accumulator -= SIM_TICK;
+                    ++steps;
+                }
+                if (steps == MAX_SIM_STEPS_PER_FRAME)
+                    accumulator = std::min(accumulator, SIM_TICK);
 
-            // Item collisions (fruits and bombs)
-            for (auto& item : items) {
-                if (item->getCollisionBounds().intersects(player.sprite.getGlobalBounds()) && !item->collected) {
-                    item->collected = true;
-                    score += item->points;
+                if (sim.isGameOver()) {
+                    state = GameState::GameOver;
+                    // Only queued here; the disk write happens off the game thread
+                    pendingRank = remoteLeaderboard ? remoteLeaderboard->submit(PLAYER_NAME, sim.score()) : localLeaderboard->submit(PLAYER_NAME, sim.score());
                 }
             }
-
-            for (auto& bomb : bombs) {
-                if (bomb.getCollisionBounds().intersects(player.sprite.getGlobalBounds())) {
-                    // Game over
-                    gameOver = true;
-                    if (handleGameOverMenu(window)) {
-                        // Restart game
-                        for (auto& item : items)
-                            delete item;
-                        items.clear();
-                        bombs.clear();
-                        score = 0;
-                        player.sprite.setPosition((WINDOW_WIDTH - PLAYER_WIDTH) / 2, WINDOW_HEIGHT - PLAYER_HEIGHT);
-                        gameOver = false;
-                    }
-                    else {
-                        // Quit game
-                        window.close();
-                    }
+        }
+        else {
+            // Menus only redraw at MENU_FRAME_RATE and sleep in between instead of spinning
+            sf::Time idle = menuFrameTime - menuClock.getElapsedTime();
+            if (idle > sf::Time::Zero)
+                sf::sleep(idle);
+            float frameTime = menuClock.restart().asSeconds();
+
+            // The server keeps running behind the menus: keep the slot alive, and
+            // start playing again when the server begins the next round
+            if (networked) {
+                netClient.update(InputState{ false, false });
+                if (netClient.view(frameTime, netView) && state == GameState::GameOver && !netView.players[netClient.getSlot()].out) {
+                    menu.clearRank();
+                    pendingRank = std::future<std::uint64_t>();
+                    state = GameState::Playing;
+                    clock.restart();
                 }
             }
 
-            // Update items (fruits and bombs)
-            for (auto it = items.begin(); it != items.end();) {
-                (*it)->update(dtSeconds);
-                if ((*it)->sprite.getPosition().y > WINDOW_HEIGHT) {
-                    delete* it;
-                    it = items.erase(it);
-                }
-                else {
-                    ++it;
-                }
+            if (pendingRank.valid() && pendingRank.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                std::uint64_t rank = pendingRank.get();
+                if (rank == LEADERBOARD_NOT_STORED)
+                    menu.setRankUnavailable();
+                else
+                    menu.setRank(rank, remoteLeaderboard ? remoteLeaderboard->size() : localLeaderboard->size());
             }
-            for (auto& bomb : bombs)
-                bomb.update(dtSeconds);
         }
 
-        // Clear window
-        window.clear();
+        if (networked)
+            sounds.update(netView.players.empty() ? 0 : netView.players[netClient.getSlot()].score, !netView.players.empty() && netView.players[netClient.getSlot()].out);
+        else
+            sounds.update(sim.score(), sim.isGameOver());
 
-        // Draw the middle tree
-        window.draw(middleTree);
+        // Finish streaming in textures without blowing the frame
+        {
+            PROFILE_SCOPE(ProfilePhase::Assets);
+            loader.update(uploadBudget);
+        }
+        if (!timelinePrinted && loader.isIdle()) {
+            loader.printTimeline(std::cout);
+            resources.printReport(std::cout);
+            timelinePrinted = true;
+        }
 
-        // Draw player
-        window.draw(player.sprite);
+        {
+            PROFILE_SCOPE(ProfilePhase::Draw);
+            // Clear window
+            window.clear();
 
-        // Draw items (fruits and bombs)
-        for (const auto& item : items) {
-            if (!item->collected)
-                window.draw(item->sprite);
-        }
+            spriteBatch.begin();
 
-        // Draw bombs
-        for (const auto& bomb : bombs) {
-            if (!bomb.collected)
-                window.draw(bomb.sprite);
-        }
+            // Draw the middle tree, centred at the top of the screen, once it has loaded
+            if (loader.isReady(background)) {
+                const sf::Texture& tree = loader.getTexture(background);
+                sf::Vector2u treeSize = tree.getSize();
+                spriteBatch.draw(tree, sf::IntRect(0, 0, treeSize.x, treeSize.y), (WINDOW_WIDTH - static_cast<float>(treeSize.x)) / 2, 0);
+            }
 
-        // Draw score
-        sf::Font font;
-        if (!font.loadFromFile("arial.ttf")) {
-            std::cerr << "Failed to load font file" << std::endl;
-            return 1;
-        }
-        sf::Text scoreText;
-        scoreText.setFont(font);
-        scoreText.setString("Score: " + std::to_string(score));
-        scoreText.setCharacterSize(24);
-        scoreText.setFillColor(sf::Color::White);
-        scoreText.setPosition(10, 10);
-        window.draw(scoreText);
+            // Fraction of a tick elapsed since the last simulation step
+            float alpha = accumulator / SIM_TICK;
+
+            if (networked) {
+                // Every player still in the round, then the items, as of the render time
+                for (const NetViewPlayer& player : netView.players) {
+                    if (!player.active || player.out)
+                        continue;
+                    sf::IntRect playerFrame(playerRegion->rect.left + player.frame * FRAME_WIDTH, playerRegion->rect.top, FRAME_WIDTH, FRAME_HEIGHT);
+                    spriteBatch.draw(atlas.pageTexture(playerRegion->page), playerFrame,
+                        player.x, WINDOW_HEIGHT - PLAYER_HEIGHT, PLAYER_SCALE, PLAYER_SCALE);
+                }
+                for (const NetViewItem& item : netView.items)
+                    drawRegion(spriteBatch, atlas, *itemRegions[static_cast<int>(item.kind)], item.x, item.y);
+            }
+            else {
+                // Draw player
+                const PlayerState& player = sim.player();
+                sf::IntRect playerFrame(playerRegion->rect.left + player.currentFrame * FRAME_WIDTH, playerRegion->rect.top, FRAME_WIDTH, FRAME_HEIGHT);
+                spriteBatch.draw(atlas.pageTexture(playerRegion->page), playerFrame,
+                    interpolate(player.prevPosX, player.posX, alpha), player.posY, PLAYER_SCALE, PLAYER_SCALE);
+
+                // Draw items (fruits and bombs)
+                const ItemPool& items = sim.items();
+                for (std::size_t i = 0; i < items.size(); ++i) {
+                    drawRegion(spriteBatch, atlas, *itemRegions[static_cast<int>(items.kind[i])],
+                        items.posX[i], interpolate(items.prevPosY[i], items.posY[i], alpha));
+                }
+            }
 
-        // Display content
-        window.display();
+            spriteBatch.flush(window);
 
+            // Draw score (geometry is only rebuilt when the score changes)
+            bool haveNetView = networked && !netView.players.empty();
+            hud.setScore(haveNetView ? netView.players[netClient.getSlot()].score : sim.score());
+            hud.draw(window);
 
+            // Draw the pause or game over overlay on top of the frozen scene
+            menu.draw(window, state);
+
+            // Frame timings of the previous frames
+            profilerOverlay.draw(window);
+        }
+
+        // Display content (includes the vsync wait)
+        {
+            PROFILE_SCOPE(ProfilePhase::Display);
+            present(window, loader, firstFrameShown);
+        }
 
+        PROFILE_FRAME_END();
     }
+    if (state == GameState::Paused)
+        reportPauseCpu(processCpuSeconds() - pauseCpuStart, pauseClock.getElapsedTime());
 
+    if (recorder.isOpen() && recorder.close(sim))
+        std::cout << "Recorded session to " << recordFile << std::endl;
+    Profiler::instance().setCsvSink(nullptr);
     return 0;
 }